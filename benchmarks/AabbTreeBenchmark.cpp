@@ -0,0 +1,96 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/constants.hpp>
+
+#include <lgl/AabbTree.h>
+#include <lgl/Camera.h>
+#include <lgl/Frustum.h>
+
+#include "Benchmark.h"
+
+namespace {
+
+constexpr auto NUM_REPETITIONS = 10;
+constexpr auto BELT_RADIUS = 150.0f;
+constexpr auto BELT_WIDTH = 25.0f;
+
+// Boxes of asteroids in a belt around the origin, as in l15_instancing
+std::vector<lgl::Aabb> createBelt(std::size_t numObjects) {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+
+    std::vector<lgl::Aabb> boxes(numObjects);
+    for (std::size_t i = 0; i < numObjects; ++i) {
+        const auto angle = glm::two_pi<float>() * i / numObjects;
+        const auto radius = BELT_RADIUS + BELT_WIDTH * uniform(random);
+        const glm::vec3 center(radius * std::cos(angle), radius * std::sin(angle), 2.0f * uniform(random));
+        const auto halfSize = glm::vec3(0.05f + 0.2f * std::abs(uniform(random)));
+        boxes[i].min = center - halfSize;
+        boxes[i].max = center + halfSize;
+    }
+    return boxes;
+}
+
+} // namespace
+
+// Culls a belt of asteroids against a camera inside it, through an AabbTree
+// as ObjectCuller does and by testing every box, and moves a tenth of them
+// per frame. Takes the number of objects as its argument.
+int main(int argc, char *argv[]) {
+    for (const auto numObjects : benchmark::getObjectCounts(argc, argv)) {
+        std::cout << numObjects << " objects\n";
+
+        auto boxes = createBelt(numObjects);
+        lgl::AabbTree tree;
+        std::vector<lgl::AabbTree::ProxyId> proxies(numObjects);
+        const auto buildTime = benchmark::measure(1, [&]{
+            for (std::size_t i = 0; i < numObjects; ++i) {
+                proxies[i] = tree.createProxy(boxes[i], static_cast<unsigned int>(i));
+            }
+        });
+        benchmark::report("build", numObjects, buildTime);
+        std::cout << "  tree height: " << tree.getHeight() << "\n";
+
+        lgl::Camera camera(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+        camera.setPosition(glm::vec3(BELT_RADIUS, 0.0f, 5.0f));
+        camera.lookAtPoint(glm::vec3(0.0f, BELT_RADIUS, 0.0f));
+        const lgl::Frustum frustum(camera.getProjectionMatrix() * camera.getViewMatrix());
+
+        std::vector<unsigned int> visible;
+        lgl::AabbTree::QueryStats stats;
+        const auto queryTime = benchmark::measure(NUM_REPETITIONS, [&]{
+            visible.clear();
+            stats = lgl::AabbTree::QueryStats();
+            tree.query(frustum, visible, &stats);
+        });
+        benchmark::report("query", numObjects, queryTime);
+        std::cout << "  stats: " << stats.numTested << " nodes tested, " << stats.numVisible << " visible\n";
+
+        std::size_t numBruteForceVisible = 0;
+        const auto bruteForceTime = benchmark::measure(NUM_REPETITIONS, [&]{
+            numBruteForceVisible = 0;
+            for (const auto &box : boxes) {
+                if (frustum.testBox(box) != lgl::Frustum::Containment::Outside) {
+                    ++numBruteForceVisible;
+                }
+            }
+        });
+        benchmark::report("test every box", numObjects, bruteForceTime);
+        std::cout << "  " << numBruteForceVisible << " visible\n";
+
+        std::size_t numReinserted = 0;
+        const auto moveTime = benchmark::measure(NUM_REPETITIONS, [&]{
+            numReinserted = 0;
+            for (std::size_t i = 0; i < numObjects; i += 10) {
+                boxes[i].min.z += 0.05f;
+                boxes[i].max.z += 0.05f;
+                numReinserted += tree.moveProxy(proxies[i], boxes[i]);
+            }
+        });
+        benchmark::report("move a tenth", numObjects, moveTime);
+        std::cout << "  " << numReinserted << " reinserted in the last frame\n";
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Helpers shared by the benchmarks, which are plain executables run by hand
+// and need no GPU or display
+namespace benchmark {
+
+// Object counts from the first argument, or a sweep from 10k to 1M
+inline std::vector<std::size_t> getObjectCounts(int argc, char *argv[]) {
+    if (argc > 1) {
+        return {static_cast<std::size_t>(std::max(1l, std::atol(argv[1])))};
+    }
+    return {10000, 100000, 1000000};
+}
+
+// Best of numRepetitions runs of function, in milliseconds
+template<typename Function>
+double measure(int numRepetitions, Function &&function) {
+    auto best = std::numeric_limits<double>::max();
+    for (auto i = 0; i < numRepetitions; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+        best = std::min(best, duration.count());
+    }
+    return best;
+}
+
+inline void report(const std::string &name, std::size_t numObjects, double milliseconds) {
+    std::cout << "  " << name << ": " << milliseconds << " ms, "
+              << 1e6 * milliseconds / numObjects << " ns per object\n";
+}
+
+} // namespace benchmark
@@ -0,0 +1,49 @@
+#include <iostream>
+#include <vector>
+
+#include <lgl/Frame.h>
+#include <lgl/TransformBatch.h>
+
+#include "Benchmark.h"
+
+namespace {
+
+constexpr auto NUM_REPETITIONS = 10;
+
+} // namespace
+
+// Times rotating objects kept as Frames and reports how much memory each
+// object takes as a Frame and in a TransformBatch. Takes the number of
+// objects as its argument.
+int main(int argc, char *argv[]) {
+    std::cout << "sizeof(Frame): " << sizeof(lgl::Frame) << " B\n"
+              << "sizeof(InstanceTransform): " << sizeof(lgl::InstanceTransform) << " B\n";
+
+    for (const auto numObjects : benchmark::getObjectCounts(argc, argv)) {
+        std::cout << numObjects << " objects\n";
+
+        std::vector<lgl::Frame> frames(numObjects);
+        const auto axis = glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f));
+
+        const auto rotateTime = benchmark::measure(NUM_REPETITIONS, [&]{
+            for (auto &frame : frames) {
+                frame.rotate(0.01f, axis);
+            }
+        });
+        benchmark::report("Frame::rotate", numObjects, rotateTime);
+
+        const auto rotateInLocalFrameTime = benchmark::measure(NUM_REPETITIONS, [&]{
+            for (auto &frame : frames) {
+                frame.rotateInLocalFrame(0.01f, axis);
+            }
+        });
+        benchmark::report("Frame::rotateInLocalFrame", numObjects, rotateInLocalFrameTime);
+
+        // A TransformBatch keeps three position, four orientation and three
+        // scale floats per object
+        std::cout << "  std::vector<Frame>: " << sizeof(lgl::Frame) * frames.capacity() / numObjects
+                  << " B per object\n"
+                  << "  TransformBatch: " << 10 * sizeof(float) << " B per object, plus "
+                  << sizeof(lgl::InstanceTransform) << " B per computed transform\n";
+    }
+}
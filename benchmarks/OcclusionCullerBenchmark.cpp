@@ -0,0 +1,90 @@
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <lgl/OcclusionCuller.h>
+
+#include "Benchmark.h"
+
+namespace {
+
+constexpr auto NUM_REPETITIONS = 10;
+constexpr auto NUM_OCCLUDERS = 64;
+
+// Closed unit cube, counter clockwise when seen from outside
+lgl::OccluderMesh createCube() {
+    lgl::OccluderMesh cube;
+    for (auto k = 0; k < 8; ++k) {
+        cube.positions.emplace_back(k & 1 ? 0.5f : -0.5f, k & 2 ? 0.5f : -0.5f, k & 4 ? 0.5f : -0.5f);
+    }
+    cube.indices = {0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6, 0, 1, 5, 0, 5, 4,
+                    2, 6, 7, 2, 7, 3, 0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5};
+    return cube;
+}
+
+} // namespace
+
+// A city of box buildings as occluders in front of small objects scattered
+// behind them, with the camera at street level. Times rasterizing the
+// occluders and testing every object. Takes the number of objects as its
+// argument.
+int main(int argc, char *argv[]) {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+
+    const auto cube = createCube();
+    std::vector<glm::mat4> buildings;
+    for (auto i = 0; i < NUM_OCCLUDERS; ++i) {
+        const glm::vec3 position(100.0f * uniform(random), -30.0f - 100.0f * std::abs(uniform(random)), 0.0f);
+        const glm::vec3 size(4.0f + 4.0f * std::abs(uniform(random)), 4.0f, 10.0f + 20.0f * std::abs(uniform(random)));
+        buildings.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position), size));
+    }
+
+    const auto view = glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, -1.0f, 2.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    const auto viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f) * view;
+
+    lgl::OcclusionCuller culler;
+    const auto rasterizeTime = benchmark::measure(NUM_REPETITIONS, [&]{
+        culler.beginFrame(viewProjection);
+        for (const auto &building : buildings) {
+            culler.addOccluder(cube, building);
+        }
+        culler.rasterize();
+    });
+    std::cout << NUM_OCCLUDERS << " occluders, " << culler.getStats().numOccluderTriangles
+              << " triangles rasterized: " << rasterizeTime << " ms\n";
+
+    for (const auto numObjects : benchmark::getObjectCounts(argc, argv)) {
+        std::cout << numObjects << " objects\n";
+
+        std::vector<lgl::Aabb> boxes(numObjects);
+        for (auto &box : boxes) {
+            const glm::vec3 center(200.0f * uniform(random), -60.0f - 200.0f * std::abs(uniform(random)),
+                                   2.0f + uniform(random));
+            box.min = center - glm::vec3(0.5f);
+            box.max = center + glm::vec3(0.5f);
+        }
+
+        std::size_t numVisible = 0;
+        const auto testTime = benchmark::measure(NUM_REPETITIONS, [&]{
+            culler.beginFrame(viewProjection);
+            for (const auto &building : buildings) {
+                culler.addOccluder(cube, building);
+            }
+            culler.rasterize();
+
+            numVisible = 0;
+            for (const auto &box : boxes) {
+                numVisible += culler.isVisible(box);
+            }
+        });
+        benchmark::report("rasterize and test", numObjects, testTime);
+
+        const auto stats = culler.getStats();
+        std::cout << "  stats: " << stats.numTested << " tested, " << stats.numOccluded << " occluded, "
+                  << numVisible << " visible\n";
+    }
+}
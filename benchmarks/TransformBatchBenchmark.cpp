@@ -0,0 +1,72 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <lgl/Frame.h>
+#include <lgl/TransformBatch.h>
+
+#include "Benchmark.h"
+
+namespace {
+
+constexpr auto NUM_REPETITIONS = 10;
+
+struct Motion {
+    glm::vec3 axis;
+    float speed;
+};
+
+std::vector<Motion> createMotions(std::size_t numObjects) {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+
+    std::vector<Motion> motions(numObjects);
+    for (auto &motion : motions) {
+        motion.axis = glm::normalize(glm::vec3(uniform(random), uniform(random), 1.0f));
+        motion.speed = uniform(random);
+    }
+    return motions;
+}
+
+} // namespace
+
+// Times recomputing model and normal matrices of objects that all rotate
+// every frame, kept either in a TransformBatch or as a vector of Frames.
+// Takes the number of objects as its argument.
+int main(int argc, char *argv[]) {
+    for (const auto numObjects : benchmark::getObjectCounts(argc, argv)) {
+        std::cout << numObjects << " objects\n";
+
+        const auto motions = createMotions(numObjects);
+        std::vector<lgl::InstanceTransform> transforms(numObjects);
+
+        std::vector<lgl::Frame> frames(numObjects);
+        lgl::TransformBatch batch;
+        for (std::size_t i = 0; i < numObjects; ++i) {
+            frames[i].setPosition(glm::vec3(static_cast<float>(i), 0.0f, 0.0f));
+            frames[i].setScale(glm::vec3(0.5f));
+            batch.add(frames[i]);
+        }
+
+        auto time = 0.0f;
+        const auto frameTime = benchmark::measure(NUM_REPETITIONS, [&]{
+            time += 0.01f;
+            for (std::size_t i = 0; i < numObjects; ++i) {
+                frames[i].setOrientation(glm::angleAxis(time * motions[i].speed, motions[i].axis));
+                transforms[i].model = frames[i].getModelMatrix();
+                transforms[i].normal = frames[i].getNormalMatrix();
+            }
+        });
+        benchmark::report("std::vector<Frame>", numObjects, frameTime);
+
+        const auto batchTime = benchmark::measure(NUM_REPETITIONS, [&]{
+            time += 0.01f;
+            for (lgl::TransformBatch::Index i = 0; i < numObjects; ++i) {
+                batch.setOrientation(i, glm::angleAxis(time * motions[i].speed, motions[i].axis));
+            }
+            batch.computeTransforms(transforms.data());
+        });
+        benchmark::report("TransformBatch", numObjects, batchTime);
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <limits>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+namespace lgl {
+
+// Axis aligned bounding box. The default box is empty and merging anything
+// into it yields that thing.
+struct Aabb {
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{std::numeric_limits<float>::lowest()};
+};
+
+bool isEmpty(const Aabb &box);
+bool contains(const Aabb &outer, const Aabb &inner);
+Aabb merge(const Aabb &a, const Aabb &b);
+Aabb merge(const Aabb &box, const glm::vec3 &point);
+Aabb inflate(const Aabb &box, float margin);
+float getSurfaceArea(const Aabb &box);
+
+// Box around the transformed box, from the absolute values of the matrix
+// (Arvo) rather than the eight transformed corners
+Aabb transform(const Aabb &box, const glm::mat4 &matrix);
+
+} // namespace lgl
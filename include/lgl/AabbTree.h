@@ -0,0 +1,75 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "Aabb.h"
+#include "Frustum.h"
+
+namespace lgl {
+
+// Dynamic bounding volume hierarchy over boxes that move. Leaves store boxes
+// enlarged by a margin, so that small moves only need a containment check,
+// and the tree is kept balanced by AVL style rotations on insertion.
+class AabbTree {
+public:
+    using ProxyId = unsigned int;
+
+    static constexpr ProxyId NULL_PROXY = std::numeric_limits<ProxyId>::max();
+
+    // Nodes tested by queries vs. leaves they returned
+    struct QueryStats {
+        unsigned long numTested = 0;
+        unsigned long numVisible = 0;
+    };
+
+    explicit AabbTree(float margin = 0.1f);
+
+    ProxyId createProxy(const Aabb &bounds, unsigned int userData);
+    void destroyProxy(ProxyId proxy);
+
+    // Returns whether the proxy had to be reinserted because bounds left its
+    // enlarged box
+    bool moveProxy(ProxyId proxy, const Aabb &bounds);
+
+    unsigned int getUserData(ProxyId proxy) const;
+    void setUserData(ProxyId proxy, unsigned int userData);
+    const Aabb &getFatBounds(ProxyId proxy) const;
+    int getHeight() const;
+
+    // Appends the user data of leaves intersecting frustum to userData.
+    // Subtrees fully inside the frustum are returned without further tests.
+    // Safe to call from several threads at once.
+    void query(const Frustum &frustum, std::vector<unsigned int> &userData, QueryStats *stats = nullptr) const;
+
+private:
+    struct Node {
+        Aabb bounds;
+        ProxyId parent;         // Next free node while on the free list
+        ProxyId children[2];
+        unsigned int userData;
+        int height;             // 0 for leaves, -1 for free nodes
+    };
+
+    ProxyId allocateNode();
+    void freeNode(ProxyId node);
+    void insertLeaf(ProxyId leaf);
+    void removeLeaf(ProxyId leaf);
+    ProxyId balance(ProxyId node);
+    ProxyId rotate(ProxyId node, int tallChild);
+    void appendLeaves(ProxyId node, std::vector<unsigned int> &userData, QueryStats *stats) const;
+    bool isLeaf(ProxyId node) const;
+
+    std::vector<Node> nodes;
+    ProxyId root = NULL_PROXY;
+    ProxyId freeList = NULL_PROXY;
+    float margin;
+};
+
+inline unsigned int AabbTree::getUserData(ProxyId proxy) const { return this->nodes[proxy].userData; }
+inline void AabbTree::setUserData(ProxyId proxy, unsigned int userData) { this->nodes[proxy].userData = userData; }
+inline const Aabb &AabbTree::getFatBounds(ProxyId proxy) const { return this->nodes[proxy].bounds; }
+inline int AabbTree::getHeight() const { return this->root == NULL_PROXY ? 0 : this->nodes[this->root].height; }
+inline bool AabbTree::isLeaf(ProxyId node) const { return this->nodes[node].children[0] == NULL_PROXY; }
+
+} // namespace lgl
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+
+namespace lgl {
+
+// Main loop advancing the simulation in fixed timesteps, independent of the
+// frame rate, and rendering in between. Frames that fall behind run at most
+// maxUpdatesPerFrame steps and drop the rest of the backlog, so a slow frame
+// never makes the next one slower.
+class Application {
+public:
+    using Duration = std::chrono::duration<float>;
+
+    // Since run() was called
+    struct Stats {
+        unsigned long numFrames = 0;
+        unsigned long numUpdates = 0;
+        unsigned long numDroppedUpdates = 0;
+    };
+
+    explicit Application(Duration timestep = Duration(1.0f / 60.0f), unsigned int maxUpdatesPerFrame = 5);
+    virtual ~Application() = default;
+
+    // Loops until isRunning() returns false
+    void run();
+
+    Duration getTimestep() const;
+    Stats getStats() const;
+
+protected:
+    virtual bool isRunning() = 0;
+
+    // Advances the simulation by timestep
+    virtual void update(Duration timestep) = 0;
+
+    // alpha in [0, 1) is how far the time of rendering lies between the last
+    // two updates, for GameObject::setRenderInterpolation() and
+    // Camera::setRenderInterpolation()
+    virtual void render(float alpha) = 0;
+
+private:
+    Duration timestep;
+    unsigned int maxUpdatesPerFrame;
+    Stats stats;
+};
+
+inline Application::Duration Application::getTimestep() const { return this->timestep; }
+inline Application::Stats Application::getStats() const { return this->stats; }
+
+} // namespace lgl
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Parallel.h"
+
+namespace lgl {
+
+// Entities sharing the same set of components, each component type stored in
+// its own contiguous array. Systems iterate only the arrays they need, in
+// memory order, and parallelForEach() splits them into chunks across threads.
+// Entity ids stay valid while other entities are destroyed.
+template <typename... Components>
+class Archetype {
+public:
+    using EntityId = unsigned int;
+
+    static constexpr EntityId NULL_ENTITY = std::numeric_limits<EntityId>::max();
+
+    // Entities per chunk handed to a thread
+    static constexpr std::size_t CHUNK_SIZE = 1024;
+
+    EntityId create(Components... components) {
+        EntityId entity;
+        if (this->freeEntities.empty()) {
+            entity = static_cast<EntityId>(this->indices.size());
+            this->indices.push_back(0);
+        } else {
+            entity = this->freeEntities.back();
+            this->freeEntities.pop_back();
+        }
+
+        this->indices[entity] = static_cast<unsigned int>(this->entities.size());
+        this->entities.push_back(entity);
+        this->append(std::index_sequence_for<Components...>(), std::move(components)...);
+        return entity;
+    }
+
+    // Moves the last entity into the hole, so the arrays stay dense
+    void destroy(EntityId entity) {
+        assert(("Entity is not alive", this->isAlive(entity)));
+        const auto index = this->indices[entity];
+        const auto last = this->entities.back();
+        this->swapRemove(std::index_sequence_for<Components...>(), index);
+        this->entities[index] = last;
+        this->entities.pop_back();
+        this->indices[last] = index;
+        this->indices[entity] = NULL_INDEX;
+        this->freeEntities.push_back(entity);
+    }
+
+    bool isAlive(EntityId entity) const {
+        return entity < this->indices.size() && this->indices[entity] != NULL_INDEX;
+    }
+
+    std::size_t getSize() const {
+        return this->entities.size();
+    }
+
+    // Dense index of an entity into the component arrays, which changes
+    // when other entities are destroyed
+    unsigned int getIndex(EntityId entity) const {
+        return this->indices[entity];
+    }
+
+    EntityId getEntity(std::size_t index) const {
+        return this->entities[index];
+    }
+
+    template <typename Component>
+    Component &get(EntityId entity) {
+        return this->getArray<Component>()[this->indices[entity]];
+    }
+
+    template <typename Component>
+    std::vector<Component> &getArray() {
+        return std::get<std::vector<Component>>(this->arrays);
+    }
+
+    template <typename Component>
+    const std::vector<Component> &getArray() const {
+        return std::get<std::vector<Component>>(this->arrays);
+    }
+
+    // Calls function(Selected &...) for every entity
+    template <typename... Selected, typename Function>
+    void forEach(Function function) {
+        this->forEachIn<Selected...>(0, this->getSize(), function);
+    }
+
+    // Like forEach(), with chunks of entities on up to numThreads threads.
+    // function must only touch the components it is given.
+    template <typename... Selected, typename Function>
+    void parallelForEach(Function function, unsigned int numThreads = 0) {
+        parallelFor(this->getSize(), CHUNK_SIZE, [this, &function](std::size_t begin, std::size_t end){
+            this->forEachIn<Selected...>(begin, end, function);
+        }, numThreads);
+    }
+
+private:
+    static constexpr unsigned int NULL_INDEX = std::numeric_limits<unsigned int>::max();
+
+    template <typename... Selected, typename Function>
+    void forEachIn(std::size_t begin, std::size_t end, Function &function) {
+        const auto pointers = std::make_tuple(this->getArray<Selected>().data()...);
+        for (auto i = begin; i < end; ++i) {
+            function(std::get<Selected *>(pointers)[i]...);
+        }
+    }
+
+    template <std::size_t... I>
+    void append(std::index_sequence<I...>, Components &&...components) {
+        const int expand[] = {0, (std::get<I>(this->arrays).push_back(std::move(components)), 0)...};
+        (void)expand;
+    }
+
+    template <std::size_t... I>
+    void swapRemove(std::index_sequence<I...>, std::size_t index) {
+        // The last element would otherwise be move assigned to itself
+        if (index + 1 != this->entities.size()) {
+            const int moves[] = {0, (std::get<I>(this->arrays)[index] = std::move(std::get<I>(this->arrays).back()), 0)...};
+            (void)moves;
+        }
+        const int pops[] = {0, (std::get<I>(this->arrays).pop_back(), 0)...};
+        (void)pops;
+    }
+
+    std::tuple<std::vector<Components>...> arrays;
+    std::vector<EntityId> entities;         // Of each index
+    std::vector<unsigned int> indices;      // Of each entity
+    std::vector<EntityId> freeEntities;
+};
+
+template <typename... Components>
+constexpr typename Archetype<Components...>::EntityId Archetype<Components...>::NULL_ENTITY;
+
+template <typename... Components>
+constexpr std::size_t Archetype<Components...>::CHUNK_SIZE;
+
+template <typename... Components>
+constexpr unsigned int Archetype<Components...>::NULL_INDEX;
+
+} // namespace lgl
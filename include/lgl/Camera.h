@@ -18,6 +18,8 @@ public:
 
     float getFOV() const;
     void setFOV(float fov_rad);
+    float getNearPlane() const;
+    float getFarPlane() const;
 
     glm::vec3 getPosition() const;
     glm::vec3 getOrientationX() const;
@@ -34,8 +36,25 @@ public:
     void rotateInLocalFrame(float angle_rad, const glm::vec3 &axis);
     void lookAtPoint(const glm::vec3 &point);
 
+    // Advances the camera by one simulation step. The frame before the step
+    // is kept for setRenderInterpolation().
     void onUpdate(Duration duration);
 
+    // Places the view alpha of the way from the frame before the last
+    // onUpdate() to the current one, 1 by default. Until the first
+    // onUpdate() the current frame is rendered as is.
+    void setRenderInterpolation(float alpha);
+
+    // Renders the current frame as is until the next onUpdate(), for moves
+    // outside of a step that should jump rather than blend in
+    void snapInterpolation();
+
+    // Frame the view is rendered from, which getViewMatrix() uses. Anything
+    // that has to match the view, like the camera position given to shaders
+    // or the distances of objects, takes it from here rather than from
+    // getPosition(), which is the simulated frame.
+    Frame getRenderFrame() const;
+
     void setLocalSpeedX(float speed);
     void setLocalSpeedY(float speed);
     void setLocalSpeedZ(float speed);
@@ -44,6 +63,9 @@ private:
     void updateProjectionMatrix();
 
     Frame frame;
+    Frame previousFrame;
+    bool hasPreviousFrame = false;
+    float renderInterpolation = 1.0f;
     glm::mat4 projectionMatrix;
     float fov_rad;
     float aspectRatio;
@@ -56,10 +78,11 @@ private:
 inline glm::vec3 Camera::getOrientationX() const { return this->frame.getOrientationX(); }
 inline glm::vec3 Camera::getOrientationY() const { return this->frame.getOrientationY(); }
 inline glm::vec3 Camera::getOrientationZ() const { return this->frame.getOrientationZ(); }
+inline float Camera::getNearPlane() const { return this->nearPlane; }
+inline float Camera::getFarPlane() const { return this->farPlane; }
 inline glm::mat4 Camera::getProjectionMatrix() const { return this->projectionMatrix; }
 inline glm::vec3 Camera::getPosition() const { return this->frame.getPosition(); }
 inline glm::mat4 Camera::getModelMatrix() const { return this->frame.getModelMatrix(); }
-inline glm::mat4 Camera::getViewMatrix() const { return this->frame.getViewMatrix(); }
 
 inline void Camera::setPosition(const glm::vec3 &position) { this->frame.setPosition(position); }
 inline void Camera::translate(const glm::vec3 &translation) { this->frame.translate(translation); }
@@ -67,5 +90,7 @@ inline void Camera::translateInLocalFrame(const glm::vec3 &translation) { this->
 inline void Camera::rotate(float angle_rad, const glm::vec3 &axis) { this->frame.rotate(angle_rad, axis); }
 inline void Camera::rotateInLocalFrame(float angle_rad, const glm::vec3 &axis) { this->frame.rotateInLocalFrame(angle_rad, axis); }
 inline void Camera::lookAtPoint(const glm::vec3 &point) { this->frame.lookAtPoint(point); }
+inline void Camera::setRenderInterpolation(float alpha) { this->renderInterpolation = alpha; }
+inline void Camera::snapInterpolation() { this->previousFrame = this->frame; }
 
 } // namespace lgl
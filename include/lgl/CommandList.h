@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "LinearAllocator.h"
+
+namespace lgl {
+
+class Mesh;
+class ShaderProgram;
+
+// Draw packets recorded without any GL calls, so that worker threads can
+// each fill a list of their own while the GL thread replays them through a
+// RenderQueue. Packets are sorted by a 64 bit key that holds, from the most
+// significant bits down,
+//
+//     pass (4) | program (12) | material (16) | vertex array (12) | depth (20)
+//
+// so passes run in order and, within equal state, draws run front to back.
+class CommandList {
+public:
+    static constexpr unsigned int MAX_NUM_PASSES = 16;
+
+    // Transforms of each draw, which RenderQueue::execute() writes into a
+    // DrawUniformBlock along with the mesh's own uniforms
+    struct DrawUniforms {
+        glm::mat4 model;
+        glm::mat3 normal;
+    };
+
+    struct Packet {
+        std::uint64_t key;
+        ShaderProgram *shaderProgram;
+        Mesh *mesh;
+        const DrawUniforms *uniforms;
+    };
+
+    // depth is the distance from the camera in [0, 1], e.g. divided by the
+    // far plane. The shader program and mesh must stay alive until the list
+    // is replayed.
+    void submit(unsigned int pass, ShaderProgram *shaderProgram, Mesh *mesh,
+                const glm::mat4 &model, const glm::mat3 &normal, float depth);
+
+    // Like submit() with a key made by the caller, e.g. to order draws some
+    // other way
+    void submit(std::uint64_t key, ShaderProgram *shaderProgram, Mesh *mesh,
+                const glm::mat4 &model, const glm::mat3 &normal);
+
+    // Also frees the uniforms of all packets
+    void clear();
+
+    std::size_t getSize() const;
+    const std::vector<Packet> &getPackets() const;
+
+private:
+    std::vector<Packet> packets;
+    LinearAllocator uniforms;
+};
+
+inline std::size_t CommandList::getSize() const { return this->packets.size(); }
+inline const std::vector<CommandList::Packet> &CommandList::getPackets() const { return this->packets; }
+
+} // namespace lgl
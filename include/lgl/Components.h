@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Aabb.h"
+#include "Frustum.h"
+#include "Parallel.h"
+#include "TransformBatch.h"
+
+namespace lgl {
+
+class GameObject;
+
+// Components for Archetype, and systems streaming through them
+
+struct TransformComponent {
+    glm::vec3 position{0.0f};
+    glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3 scale{1.0f};
+};
+
+struct VelocityComponent {
+    glm::vec3 linear{0.0f};
+    glm::vec3 angular{0.0f};    // Rotation axis scaled by radians per second
+};
+
+struct BoundsComponent {
+    Aabb local;
+    Aabb world;                 // Up to date as of the last updateWorldBounds()
+};
+
+// Model drawn for the entity, whose meshes must outlive it
+struct RenderComponent {
+    GameObject *model;
+};
+
+glm::mat4 getModelMatrix(const TransformComponent &transform);
+
+// Explicit Euler step, renormalizing the orientation
+void integrate(TransformComponent &transform, const VelocityComponent &velocity, float duration);
+
+template <typename Store>
+void integrateVelocities(Store &store, float duration) {
+    store.template parallelForEach<TransformComponent, VelocityComponent>(
+                [duration](TransformComponent &transform, const VelocityComponent &velocity){
+        integrate(transform, velocity, duration);
+    });
+}
+
+template <typename Store>
+void updateWorldBounds(Store &store) {
+    store.template parallelForEach<TransformComponent, BoundsComponent>(
+                [](const TransformComponent &transform, BoundsComponent &bounds){
+        bounds.world = lgl::transform(bounds.local, getModelMatrix(transform));
+    });
+}
+
+// Replaces visibleIndices with the indices of entities whose world bounds
+// intersect frustum, in index order
+template <typename Store>
+void collectVisible(Store &store, const Frustum &frustum, std::vector<unsigned int> &visibleIndices) {
+    // Each chunk collects its own indices, concatenated in order afterwards
+    const auto chunkSize = Store::CHUNK_SIZE;
+    std::vector<std::vector<unsigned int>> chunkIndices((store.getSize() + chunkSize - 1) / chunkSize);
+    const auto &bounds = store.template getArray<BoundsComponent>();
+    parallelFor(store.getSize(), chunkSize, [&](std::size_t begin, std::size_t end){
+        auto &indices = chunkIndices[begin / chunkSize];
+        for (auto i = begin; i < end; ++i) {
+            if (frustum.testBox(bounds[i].world) != Frustum::Containment::Outside) {
+                indices.push_back(static_cast<unsigned int>(i));
+            }
+        }
+    });
+
+    visibleIndices.clear();
+    for (const auto &indices : chunkIndices) {
+        visibleIndices.insert(visibleIndices.cend(), indices.cbegin(), indices.cend());
+    }
+}
+
+// Replaces instances with the transforms of the entities at indices drawn
+// with model, for GameObject::renderInstanced()
+template <typename Store>
+void buildInstances(Store &store, const std::vector<unsigned int> &indices, const GameObject *model,
+                    TransformBatch &instances) {
+    const auto &transforms = store.template getArray<TransformComponent>();
+    const auto &renders = store.template getArray<RenderComponent>();
+    instances.clear();
+    for (auto i : indices) {
+        if (renders[i].model == model) {
+            instances.add(transforms[i].position, transforms[i].orientation, transforms[i].scale);
+        }
+    }
+}
+
+} // namespace lgl
@@ -3,14 +3,21 @@
 #include <glm/mat3x3.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 namespace lgl {
 
+// Orientation is kept as a unit quaternion, which composes rotations cheaply
+// and is renormalized after each of them, so it never drifts away from a
+// rotation. Matrices are computed whenever they are asked for and not cached
+// here, which keeps a frame small; SceneGraph and TransformBatch keep them for
+// objects that are drawn.
 class Frame {
 public:
     glm::vec3 getScale() const;
     glm::vec3 getPosition() const;
     glm::mat3 getOrientation() const;
+    glm::quat getOrientationQuaternion() const;
     glm::vec3 getOrientationX() const;
     glm::vec3 getOrientationY() const;
     glm::vec3 getOrientationZ() const;
@@ -18,8 +25,12 @@ public:
     glm::mat4 getViewMatrix() const;
     glm::mat3 getNormalMatrix() const;
 
+    // Changes whenever the frame moves, rotates or scales
+    unsigned long getVersion() const;
+
     void setScale(const glm::vec3 &scale);
     void setPosition(const glm::vec3 &position);
+    void setOrientation(const glm::quat &orientation);
     void translate(const glm::vec3 &translation);
     void translateInLocalFrame(const glm::vec3 &translation);
     void rotate(float angle_rad, const glm::vec3 &axis);
@@ -27,19 +38,26 @@ public:
     void lookAtPoint(const glm::vec3 &point);
 
 private:
+    void composeOrientation(const glm::quat &orientation);
+
     glm::vec3 scale{1.0f};
     glm::vec3 position{0.0f};
-    glm::mat3 orientation{1.0f};
+    glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
 
-    mutable bool normalMatrixIsValid = true;
-    mutable glm::mat3 normalMatrix{1.0f};
+    unsigned long version = 0;
 };
 
+// Blends position and scale linearly and orientation spherically, with
+// alpha 0 giving previous and 1 giving current
+Frame interpolate(const Frame &previous, const Frame &current, float alpha);
+
 inline glm::vec3 Frame::getScale() const { return this->scale; }
 inline glm::vec3 Frame::getPosition() const { return this->position; }
-inline glm::mat3 Frame::getOrientation() const { return this->orientation; }
-inline glm::vec3 Frame::getOrientationX() const { return this->orientation[0]; }
-inline glm::vec3 Frame::getOrientationY() const { return this->orientation[1]; }
-inline glm::vec3 Frame::getOrientationZ() const { return this->orientation[2]; }
+inline glm::mat3 Frame::getOrientation() const { return glm::mat3_cast(this->orientation); }
+inline glm::quat Frame::getOrientationQuaternion() const { return this->orientation; }
+inline glm::vec3 Frame::getOrientationX() const { return this->orientation * glm::vec3(1.0f, 0.0f, 0.0f); }
+inline glm::vec3 Frame::getOrientationY() const { return this->orientation * glm::vec3(0.0f, 1.0f, 0.0f); }
+inline glm::vec3 Frame::getOrientationZ() const { return this->orientation * glm::vec3(0.0f, 0.0f, 1.0f); }
+inline unsigned long Frame::getVersion() const { return this->version; }
 
 } // namespace lgl
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "Aabb.h"
+
+namespace lgl {
+
+// The six clip planes of a projection, pointing inwards
+class Frustum {
+public:
+    enum class Containment {
+        Outside,
+        Intersecting,
+        Inside
+    };
+
+    // matrix maps into clip space, e.g. projection * view * model to get the
+    // frustum in model space
+    explicit Frustum(const glm::mat4 &matrix);
+
+    bool intersectsSphere(const glm::vec3 &center, float radius) const;
+
+    // Conservative, boxes near a corner of the frustum may be reported as
+    // intersecting while outside
+    Containment testBox(const Aabb &box) const;
+
+private:
+    std::array<glm::vec4, 6> planes;
+};
+
+} // namespace lgl
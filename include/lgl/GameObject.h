@@ -4,29 +4,79 @@
 #include <string>
 #include <vector>
 
-#include <assimp/scene.h>
 #include <glm/vec3.hpp>
 #include <glm/mat4x4.hpp>
 
+#include "Aabb.h"
+#include "Camera.h"
 #include "Frame.h"
+#include "GeometryPool.h"
+#include "GlHandle.h"
 #include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Meshlet.h"
+#include "OcclusionCuller.h"
+#include "SceneGraph.h"
+#include "TransformBatch.h"
+#include "Vertex.h"
 
 namespace lgl {
 
+class CommandList;
+class MultiDrawBatch;
 class ShaderProgram;
+class UniformRingBuffer;
+
+// Largest geometric error a level of detail may show on screen, as a fraction
+// of the viewport height
+constexpr float DEFAULT_MAX_LOD_ERROR = 0.001f;
+
+// How the meshes of a model are prepared when it is loaded
+struct ModelSettings {
+    LodSettings lods;
+    MeshletSettings meshlets;
+
+    // Merge meshes with the same textures into one, pre-transformed by their
+    // node transforms, so that draw calls scale with materials, not meshes.
+    // Otherwise the node hierarchy is kept in the game object's scene graph.
+    bool isStaticBatched = true;
+
+    // Keep the positions and coarsest level of detail of each mesh on the CPU
+    // for rasterizeOccluder()
+    bool isOccluder = false;
+};
 
 class GameObject {
 private:
     using Duration = std::chrono::duration<float>;
 
 public:
-    explicit GameObject(const std::string &pathname);
+    explicit GameObject(const std::string &pathname,
+                        VertexFormat vertexFormat = VertexFormat::Float,
+                        const ModelSettings &settings = ModelSettings());
+
+    // Loads all meshes into geometryPool, which must outlive the game object
+    GameObject(const std::string &pathname, GeometryPool *geometryPool,
+               const ModelSettings &settings = ModelSettings());
 
     glm::vec3 getPosition() const;
     glm::vec3 getOrientationX() const;
     glm::vec3 getOrientationY() const;
     glm::vec3 getOrientationZ() const;
     glm::mat4 getModelMatrix() const;
+    MeshOptimizationStats getMeshOptimizationStats() const;
+    std::size_t getNumTriangles() const;
+
+    // Bounds of all meshes placed by the frame and scene graph. Cached until
+    // getTransformVersion() changes.
+    const Aabb &getWorldBounds();
+
+    // Changes whenever the frame or the scene graph does
+    unsigned long getTransformVersion() const;
+
+    // Root node is placed by the game object's frame, below it are the model's nodes
+    SceneGraph &getSceneGraph();
 
     void setScale(const glm::vec3 &scale);
     void setPosition(const glm::vec3 &position);
@@ -35,15 +85,90 @@ public:
     void rotate(float angle_rad, const glm::vec3 &axis);
     void rotateInLocalFrame(float angle_rad, const glm::vec3 &axis);
     void lookAtPoint(const glm::vec3 &point);
+    void setMaxLodError(float maxError);
 
+    // Advances the game object by one simulation step. The frame before the
+    // step is kept for setRenderInterpolation(), so call this before moving
+    // the object during the step.
     void onUpdate(Duration duration);
+
+    // Renders the object alpha of the way from the frame before the last
+    // onUpdate() to the current one, 1 by default. Until the first
+    // onUpdate() the current frame is rendered as is.
+    void setRenderInterpolation(float alpha);
+
+    // Renders the current frame as is until the next onUpdate(), for moves
+    // outside of a step that should jump rather than blend in
+    void snapInterpolation();
+
+    // Frame the object is rendered at
+    Frame getRenderFrame() const;
+
     void render(ShaderProgram *shaderProgram);
 
+    // Selects the level of detail of each mesh from its error projected by
+    // camera and skips meshlets outside its frustum or facing away from it
+    void render(ShaderProgram *shaderProgram, const Camera &camera);
+
+    // Writes the transforms and shine of all meshes into uniformRingBuffer at
+    // once and binds each mesh's range instead of setting uniforms per mesh.
+    // Needs DRAW_UNIFORM_BLOCK in the shaders and a begun ring buffer frame,
+    // which grows if the meshes don't fit.
+    void render(ShaderProgram *shaderProgram, UniformRingBuffer &uniformRingBuffer);
+
+    // Selects levels of detail like render() and submits every mesh to
+    // commandList, keyed by its distance from the camera. Makes no GL calls,
+    // so different game objects can record from different threads. The game
+    // object must stay alive until the list is replayed.
+    void submit(CommandList &commandList, ShaderProgram *shaderProgram, const Camera &camera,
+                unsigned int pass = 0);
+
+    // Selects levels of detail like render() and adds every mesh to
+    // multiDrawBatch. Needs a model loaded into a geometry pool.
+    void submit(MultiDrawBatch &multiDrawBatch, const Camera &camera);
+
+    // Sets only the model matrix and draws positions only, for depth and
+    // shadow passes with a matching shader like shaders/depth.vert
+    void renderDepth(ShaderProgram *shaderProgram);
+
+    // Draws every mesh once per instance with one instanced draw call each,
+    // placing instances by their transforms instead of the game object's
+    // frame. Needs a statically batched model and INSTANCED defined in the
+    // vertex shader. Transforms are uploaded again only when they change.
+    void renderInstanced(ShaderProgram *shaderProgram, const TransformBatch &instances);
+    void renderInstanced(ShaderProgram *shaderProgram, const std::vector<Frame> &instances);
+
+    // Adds the meshes to occlusionCuller as occluders. Does nothing unless
+    // the model was loaded with ModelSettings::isOccluder.
+    void rasterizeOccluder(OcclusionCuller &occlusionCuller);
+
 private:
-    void processNode(const aiNode *node, const aiScene *scene, const std::string &dir);
+    void load(const std::string &pathname, VertexFormat vertexFormat, GeometryPool *geometryPool,
+              const ModelSettings &settings);
+    void updateTransforms();
+    void selectLods(const Camera &camera);
 
     Frame frame;
+    Frame previousFrame;
+    bool hasPreviousFrame = false;
+    float renderInterpolation = 1.0f;
+    SceneGraph sceneGraph;
     std::vector<Mesh> meshes;
+    std::vector<SceneGraph::NodeId> meshNodes;
+    std::vector<OccluderMesh> occluders;
+    MeshOptimizationStats meshOptimizationStats;
+    std::vector<std::size_t> drawUniformOffsets;
+    float maxLodError = DEFAULT_MAX_LOD_ERROR;
+
+    // Instance transforms last uploaded to instanceBuffer
+    BufferHandle instanceBuffer;
+    const TransformBatch *uploadedInstances = nullptr;
+    unsigned long uploadedInstancesVersion = 0;
+    TransformBatch frameInstances;
+
+    Aabb worldBounds;
+    bool worldBoundsAreValid = false;
+    unsigned long worldBoundsVersion = 0;
 };
 
 inline glm::vec3 GameObject::getOrientationX() const { return this->frame.getOrientationX(); }
@@ -51,6 +176,9 @@ inline glm::vec3 GameObject::getOrientationY() const { return this->frame.getOri
 inline glm::vec3 GameObject::getOrientationZ() const { return this->frame.getOrientationZ(); }
 inline glm::vec3 GameObject::getPosition() const { return this->frame.getPosition(); }
 inline glm::mat4 GameObject::getModelMatrix() const { return this->frame.getModelMatrix(); }
+inline MeshOptimizationStats GameObject::getMeshOptimizationStats() const { return this->meshOptimizationStats; }
+inline SceneGraph &GameObject::getSceneGraph() { return this->sceneGraph; }
+inline unsigned long GameObject::getTransformVersion() const { return this->frame.getVersion() + this->sceneGraph.getVersion(); }
 
 inline void GameObject::setScale(const glm::vec3 &scale) { this->frame.setScale(scale); }
 inline void GameObject::setPosition(const glm::vec3 &position) { this->frame.setPosition(position); }
@@ -59,5 +187,8 @@ inline void GameObject::translateInLocalFrame(const glm::vec3 &translation) { th
 inline void GameObject::rotate(float angle_rad, const glm::vec3 &axis) { this->frame.rotate(angle_rad, axis); }
 inline void GameObject::rotateInLocalFrame(float angle_rad, const glm::vec3 &axis) { this->frame.rotateInLocalFrame(angle_rad, axis); }
 inline void GameObject::lookAtPoint(const glm::vec3 &point) { this->frame.lookAtPoint(point); }
+inline void GameObject::setMaxLodError(float maxError) { this->maxLodError = maxError; }
+inline void GameObject::setRenderInterpolation(float alpha) { this->renderInterpolation = alpha; }
+inline void GameObject::snapInterpolation() { this->previousFrame = this->frame; }
 
 } // namespace lgl
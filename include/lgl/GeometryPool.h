@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "GlHandle.h"
+#include "RangeAllocator.h"
+#include "Vertex.h"
+
+namespace lgl {
+
+// Sub-allocates the vertices and indices of many meshes with the same vertex
+// format from one shared vertex buffer and one shared index buffer, so that
+// all of them draw from a single vertex array with base vertex offsets.
+// Indices are relative to each allocation, so they are stored as 16 bits until
+// a mesh with more than 65536 vertices widens the whole pool to 32 bits.
+// VertexFormat::Split is not supported.
+class GeometryPool {
+public:
+    using AllocationId = unsigned int;
+
+    struct AllocationDeleter {
+        GeometryPool *geometryPool = nullptr;
+        void operator()(AllocationId *id) const;
+    };
+
+    // Frees the allocation from its pool when destroyed
+    using AllocationPtr = std::unique_ptr<AllocationId, AllocationDeleter>;
+
+    // Layout of the commands glMultiDrawElementsIndirect reads
+    struct DrawCommand {
+        unsigned int count;
+        unsigned int instanceCount;
+        unsigned int firstIndex;
+        int baseVertex;
+        unsigned int baseInstance;
+    };
+
+    // Draw calls made through any pool. The vertex array binds that sharing
+    // one vertex array saves show up in GlState::Stats::vertexArrays.
+    struct Stats {
+        unsigned long numDraws = 0;
+    };
+
+    explicit GeometryPool(VertexFormat vertexFormat,
+                          std::size_t vertexCapacity = 1u << 16,
+                          std::size_t indexCapacity = 1u << 18);
+
+    // Allocations point back at their pool, so it stays where it was created
+    GeometryPool(const GeometryPool &) = delete;
+    GeometryPool &operator=(const GeometryPool &) = delete;
+    GeometryPool(GeometryPool &&) = delete;
+    GeometryPool &operator=(GeometryPool &&) = delete;
+
+    VertexFormat getVertexFormat() const;
+    unsigned int getVertexArray() const;
+
+    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, for draws from the vertex array
+    unsigned int getIndexType() const;
+    std::size_t getIndexSize() const;
+
+    // vertexData holds numVertices vertices of the pool's vertex format and
+    // indices are relative to the first of them
+    AllocationPtr allocate(const void *vertexData, std::size_t numVertices,
+                           const std::vector<unsigned int> &indices);
+
+    void draw(AllocationId id);
+
+    // Draws numIndices of the allocation's indices starting at firstIndex
+    void draw(AllocationId id, std::size_t firstIndex, std::size_t numIndices);
+
+    // Draws several index ranges of the allocation in one call
+    void draw(AllocationId id, const std::vector<std::size_t> &firstIndices, const std::vector<int> &counts);
+
+    // Draws the index range once per InstanceTransform in instanceBuffer
+    void drawInstanced(AllocationId id, std::size_t firstIndex, std::size_t numIndices,
+                       unsigned int instanceBuffer, std::size_t numInstances);
+
+    // Command drawing the index range once, for indirect draws from the
+    // pool's vertex array
+    DrawCommand getDrawCommand(AllocationId id, std::size_t firstIndex, std::size_t numIndices) const;
+
+    // Moves all live allocations to the front of the buffers, closing gaps
+    // left behind by freed allocations
+    void defragment();
+
+    std::size_t getNumFreeVertices() const;
+    std::size_t getNumFreeIndices() const;
+
+    static Stats getStats();
+    static void resetStats();
+
+private:
+    using Range = RangeAllocator::Range;
+
+    struct Allocation {
+        Range vertices;
+        Range indices;
+    };
+
+    void free(AllocationId id);
+    void setupVertexArray();
+    void widenIndices();
+    void resizeBuffers(std::size_t vertexCapacity, std::size_t indexCapacity);
+
+    VertexArrayHandle vao;
+    BufferHandle vbo;
+    BufferHandle ebo;
+    VertexFormat vertexFormat;
+    std::size_t vertexSize;
+    unsigned int indexType;
+    std::size_t indexSize;
+
+    std::vector<Allocation> allocations;
+    std::vector<bool> isAllocationLive;
+    std::vector<AllocationId> freeAllocationIds;
+    RangeAllocator vertexRanges;
+    RangeAllocator indexRanges;
+
+    // Multi draw arguments, kept to reuse their storage
+    std::vector<const void *> drawOffsets;
+    std::vector<int> drawBaseVertices;
+};
+
+inline VertexFormat GeometryPool::getVertexFormat() const { return this->vertexFormat; }
+inline unsigned int GeometryPool::getVertexArray() const { return this->vao.get(); }
+inline unsigned int GeometryPool::getIndexType() const { return this->indexType; }
+inline std::size_t GeometryPool::getIndexSize() const { return this->indexSize; }
+
+} // namespace lgl
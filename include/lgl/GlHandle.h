@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+
+namespace lgl {
+
+enum class GlObject {
+    Buffer,
+    VertexArray,
+    Texture,
+    Shader,
+    Program
+};
+
+// Deletes the GL object right away, or queues it while the deletion queue
+// is enabled
+void deleteGlObject(GlObject kind, unsigned int id);
+
+// Generates a GL object. Shaders need a type and are created by the caller.
+unsigned int createGlObject(GlObject kind);
+
+// Owns a GL object name. Move only, stored inline and deleted without an
+// indirect deleter call. 0 means no object.
+template <GlObject Kind>
+class GlHandle {
+public:
+    GlHandle() = default;
+    explicit GlHandle(unsigned int id) : id(id) {}
+
+    GlHandle(const GlHandle &) = delete;
+    GlHandle &operator=(const GlHandle &) = delete;
+
+    GlHandle(GlHandle &&other) noexcept : id(other.release()) {}
+
+    GlHandle &operator=(GlHandle &&other) noexcept {
+        this->reset(other.release());
+        return *this;
+    }
+
+    ~GlHandle() {
+        this->reset();
+    }
+
+    static GlHandle create() {
+        return GlHandle(createGlObject(Kind));
+    }
+
+    unsigned int get() const {
+        return this->id;
+    }
+
+    explicit operator bool() const {
+        return this->id != 0;
+    }
+
+    unsigned int release() {
+        const auto id = this->id;
+        this->id = 0;
+        return id;
+    }
+
+    void reset(unsigned int id = 0) {
+        if (this->id != 0) {
+            deleteGlObject(Kind, this->id);
+        }
+        this->id = id;
+    }
+
+private:
+    unsigned int id = 0;
+};
+
+using BufferHandle = GlHandle<GlObject::Buffer>;
+using VertexArrayHandle = GlHandle<GlObject::VertexArray>;
+using TextureHandle = GlHandle<GlObject::Texture>;
+using ShaderHandle = GlHandle<GlObject::Shader>;
+using ProgramHandle = GlHandle<GlObject::Program>;
+
+// While enabled, destroyed handles only queue their objects, so that
+// destroying many objects mid-frame never stalls. flush() then deletes them
+// with one glDelete* call per kind, e.g. right after swapping buffers.
+class GlDeletionQueue {
+public:
+    static void setEnabled(bool isEnabled);
+    static bool isEnabled();
+    static std::size_t getSize();
+    static void flush();
+};
+
+} // namespace lgl
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+
+#include "GlHandle.h"
+
+namespace lgl {
+
+// Shadows the bindings and capabilities of the current GL context, so that
+// requesting what is already set makes no GL call. All lgl classes bind
+// through it. After changing any of this state with raw GL calls, call
+// invalidate(), which makes the next request of each kind reach GL again.
+class GlState {
+public:
+    // GL calls made vs. requests filtered out as redundant
+    struct Counts {
+        unsigned long numCalls = 0;
+        unsigned long numSkippedCalls = 0;
+    };
+
+    // Counts per kind of state, e.g. vertexArrays for the binds a geometry
+    // pool saves by sharing one vertex array
+    struct Stats {
+        Counts programs;
+        Counts vertexArrays;
+        Counts textureUnits;
+        Counts textures;
+        Counts capabilities;
+
+        Counts getTotal() const;
+    };
+
+    static void useProgram(unsigned int program);
+    static void bindVertexArray(unsigned int vertexArray);
+
+    // unit counts from 0, not from GL_TEXTURE0
+    static void activeTexture(unsigned int unit);
+
+    // Binds to the active texture unit
+    static void bindTexture2D(unsigned int texture);
+
+    // glEnable() or glDisable() of capability, e.g. GL_DEPTH_TEST
+    static void setEnabled(unsigned int capability, bool isEnabled);
+
+    static void invalidate();
+
+    // Called by deleteGlObject(), since GL unbinds deleted objects and may
+    // hand their names out again
+    static void onDelete(GlObject kind, const unsigned int *ids, std::size_t numIds);
+
+    static Stats getStats();
+    static void resetStats();
+};
+
+} // namespace lgl
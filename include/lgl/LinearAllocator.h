@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lgl {
+
+// Hands out memory by bumping an offset through large blocks and frees all
+// of it at once with reset(), which keeps the blocks for reuse. Destructors
+// are never run. Not thread safe, so give each thread an allocator of its own.
+class LinearAllocator {
+public:
+    explicit LinearAllocator(std::size_t blockSize = 64 * 1024);
+
+    // alignment must be a power of two
+    void *allocate(std::size_t size, std::size_t alignment);
+
+    template <typename T, typename... Args>
+    T *create(Args &&...args);
+
+    void reset();
+
+    // Since the last reset()
+    std::size_t getNumBytesAllocated() const;
+
+private:
+    std::vector<std::unique_ptr<unsigned char[]>> blocks;
+    std::size_t blockSize;
+    std::size_t currentBlock = 0;
+    std::size_t offset = 0;
+    std::size_t numBytesAllocated = 0;
+};
+
+template <typename T, typename... Args>
+T *LinearAllocator::create(Args &&...args) {
+    static_assert(std::is_trivially_destructible<T>::value, "Linear allocations are never destroyed");
+    return new (this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+}
+
+inline std::size_t LinearAllocator::getNumBytesAllocated() const { return this->numBytesAllocated; }
+
+} // namespace lgl
@@ -1,35 +1,194 @@
 #pragma once
 
-#include <memory>
 #include <string>
 #include <vector>
 
+#include <glm/vec3.hpp>
+
+#include "Aabb.h"
+#include "Frustum.h"
+#include "GeometryPool.h"
+#include "GlHandle.h"
+#include "MeshSimplifier.h"
+#include "Meshlet.h"
 #include "Texture2D.h"
+#include "TransformBatch.h"
+#include "Vertex.h"
 
 namespace lgl {
 
-class Vertex;
 class ShaderProgram;
 
+// Shine of materials that don't set one
+constexpr float DEFAULT_SHINE = 32.0f;
+
 class Mesh {
 private:
     using IndexContainer = std::vector<unsigned int>;
 
 public:
+    // Meshlets tested by any mesh vs. those culled
+    struct MeshletStats {
+        unsigned long numMeshlets = 0;
+        unsigned long numFrustumCulled = 0;
+        unsigned long numBackfaceCulled = 0;
+    };
+
     Mesh(const std::vector<Vertex> &vertices,
          const IndexContainer &indices,
          const std::vector<Texture2D> diffuseTextures,
-         const std::vector<Texture2D> specularTextures);
+         const std::vector<Texture2D> specularTextures,
+         VertexFormat vertexFormat = VertexFormat::Float,
+         const std::vector<LodLevel> &coarserLods = {},
+         const std::vector<Meshlet> &meshlets = {});
+
+    // Sub-allocates the vertices and indices from geometryPool, which must
+    // outlive the mesh, instead of creating buffers of its own
+    Mesh(const std::vector<Vertex> &vertices,
+         const IndexContainer &indices,
+         const std::vector<Texture2D> diffuseTextures,
+         const std::vector<Texture2D> specularTextures,
+         GeometryPool *geometryPool,
+         const std::vector<LodLevel> &coarserLods = {},
+         const std::vector<Meshlet> &meshlets = {});
+
+    std::size_t getNumLods() const;
+    std::size_t getLod() const;
+    std::size_t getNumTriangles() const;
+
+    // Bounds of the vertices in model space
+    const Aabb &getBounds() const;
 
+    // Switches to the coarsest level whose error, multiplied by errorScale,
+    // stays below maxError. Levels only change once the error leaves a band
+    // around maxError, so that they don't flicker back and forth.
+    void selectLod(float errorScale, float maxError);
+
+    // Draws the selected level of detail
     void render(ShaderProgram *shaderProgram);
 
+    // render() in two steps, so that meshes sharing a material bind it once
+    void bindMaterial(ShaderProgram *shaderProgram);
+    void draw(ShaderProgram *shaderProgram);
+
+    // Draws with a program that has DRAW_UNIFORM_BLOCK, which reads the
+    // per draw uniforms from the bound getDrawUniformBlock() instead
+    void draw();
+    DrawUniformBlock getDrawUniformBlock(const glm::mat4 &model, const glm::mat3 &normal) const;
+
+    // Specular exponent of the material. Programs with DRAW_UNIFORM_BLOCK
+    // read it per draw, others take material.shine from the application.
+    float getShine() const;
+    void setShine(float shine);
+
+    // Whether both meshes bind the same textures to the same samplers
+    bool hasSameMaterial(const Mesh &other) const;
+
+    // Equal for meshes with the same material, for sorting draws
+    unsigned int getMaterialKey() const;
+
+    // Vertex array the mesh draws from, shared by geometry pool meshes
+    unsigned int getVertexArray() const;
+
+    // Null unless the mesh was allocated from a geometry pool
+    GeometryPool *getGeometryPool() const;
+
+    // Selected level of detail as an indirect command of the geometry pool
+    GeometryPool::DrawCommand getDrawCommand() const;
+
+    // Compact positions are position * scale + offset in model space
+    const glm::vec3 &getPositionScale() const;
+    const glm::vec3 &getPositionOffset() const;
+
+    // Draws only the meshlets inside frustum and facing cameraPosition, both
+    // in model space. Meshlets cover the full detail level only, so coarser
+    // levels are drawn in full.
+    void render(ShaderProgram *shaderProgram, const Frustum &frustum, const glm::vec3 &cameraPosition);
+
+    // Draws the selected level of detail fetching positions only, for depth
+    // and shadow passes. Only VertexFormat::Split meshes save bandwidth.
+    void renderDepth(ShaderProgram *shaderProgram);
+
+    // Draws the selected level of detail once per InstanceTransform in
+    // instanceBuffer, with INSTANCED defined in the vertex shader
+    void renderInstanced(ShaderProgram *shaderProgram, unsigned int instanceBuffer, std::size_t numInstances);
+
+    static MeshletStats getMeshletStats();
+    static void resetMeshletStats();
+
 private:
-    std::unique_ptr<unsigned int, void(*)(unsigned int *)> vao;
-    std::unique_ptr<unsigned int, void(*)(unsigned int *)> vbo;
-    std::unique_ptr<unsigned int, void(*)(unsigned int *)> ebo;
-    std::vector<Texture2D> diffuseTextures;
-    std::vector<Texture2D> specularTextures;
-    IndexContainer::size_type numIndices;
+    // Texture bound to the unit the shader program assigned to samplerName
+    struct TextureSlot {
+        std::string samplerName;
+        Texture2D texture;
+    };
+
+    // Texture unit of each slot as resolved for one shader program
+    struct SlotTextureUnits {
+        unsigned int program;
+        std::vector<int> textureUnits;
+    };
+
+    // Consecutive range of the index buffer
+    struct Lod {
+        std::size_t firstIndex;
+        std::size_t numIndices;
+        float error;
+    };
+
+    IndexContainer setLods(const IndexContainer &indices, const std::vector<LodLevel> &coarserLods);
+    void setTextures(const std::vector<Texture2D> &diffuseTextures,
+                     const std::vector<Texture2D> &specularTextures);
+    void setPositionBounds(const std::vector<Vertex> &vertices);
+    const std::vector<int> &getTextureUnits(const ShaderProgram &shaderProgram);
+    void setVertexUniforms(ShaderProgram *shaderProgram);
+    void drawRanges(bool positionsOnly = false);
+
+    VertexArrayHandle vao;
+    BufferHandle vbo;
+    BufferHandle ebo;
+
+    // Position stream and vertex array binding only it, for VertexFormat::Split
+    BufferHandle positionVbo;
+    VertexArrayHandle depthVao;
+    GeometryPool::AllocationPtr geometryAllocation;
+    std::vector<TextureSlot> textureSlots;
+
+    // Resolved once per shader program the mesh is drawn with, so that
+    // binding the material does no string lookups
+    std::vector<SlotTextureUnits> slotTextureUnits;
+    unsigned int materialKey = 0;
+    std::vector<Lod> lods;
+    std::size_t currentLod = 0;
+    std::vector<Meshlet> meshlets;
+
+    // Of the mesh's own index buffer. Pool meshes have none and draw with the
+    // index type of their pool, so theirs stays 0.
+    unsigned int indexType = 0;
+
+    // Index ranges to draw, kept to reuse their storage
+    std::vector<std::size_t> drawFirstIndices;
+    std::vector<int> drawCounts;
+    std::vector<const void *> drawOffsets;
+
+    Aabb bounds;
+
+    // Maps compact unsigned normalized positions back into the mesh bounds
+    VertexFormat vertexFormat;
+    glm::vec3 positionScale{1.0f};
+    glm::vec3 positionOffset{0.0f};
+
+    float shine = DEFAULT_SHINE;
 };
 
+inline std::size_t Mesh::getNumLods() const { return this->lods.size(); }
+inline std::size_t Mesh::getLod() const { return this->currentLod; }
+inline std::size_t Mesh::getNumTriangles() const { return this->lods[this->currentLod].numIndices / 3; }
+inline const Aabb &Mesh::getBounds() const { return this->bounds; }
+inline unsigned int Mesh::getMaterialKey() const { return this->materialKey; }
+inline const glm::vec3 &Mesh::getPositionScale() const { return this->positionScale; }
+inline const glm::vec3 &Mesh::getPositionOffset() const { return this->positionOffset; }
+inline float Mesh::getShine() const { return this->shine; }
+inline void Mesh::setShine(float shine) { this->shine = shine; }
+
 } // namespace lgl
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace lgl {
+
+struct Vertex;
+
+// Post-transform vertex cache efficiency of an indexed triangle list
+struct VertexCacheStats {
+    std::size_t numTriangles = 0;
+    std::size_t numVertices = 0;
+    std::size_t numTransformedVertices = 0;
+
+    // Average cache miss ratio: vertices transformed per triangle (0.5 - 3.0)
+    float getACMR() const;
+
+    // Average transform to vertex ratio: vertices transformed per vertex (>= 1.0)
+    float getATVR() const;
+
+    VertexCacheStats &operator+=(const VertexCacheStats &other);
+};
+
+struct MeshOptimizationStats {
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+constexpr unsigned int DEFAULT_VERTEX_CACHE_SIZE = 16;
+constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+// Merges vertices with identical attributes and remaps indices to them. With a
+// positive epsilon, attributes are quantized to multiples of epsilon before
+// comparison, so nearly identical vertices are merged as well. Returns the
+// number of vertices removed.
+std::size_t weldVertices(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices,
+                         float epsilon = 0.0f);
+
+// Simulates a FIFO post-transform vertex cache over the triangles in indices
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int> &indices,
+                                    std::size_t numVertices,
+                                    unsigned int cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Reorders triangles for vertex cache locality (Tipsify)
+std::vector<unsigned int> optimizeVertexCache(const std::vector<unsigned int> &indices,
+                                              std::size_t numVertices,
+                                              unsigned int cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Reorders clusters of a cache optimized triangle list so that outward facing
+// clusters are drawn first. threshold bounds how much the ACMR may degrade.
+std::vector<unsigned int> optimizeOverdraw(const std::vector<unsigned int> &indices,
+                                           const std::vector<Vertex> &vertices,
+                                           float threshold = DEFAULT_OVERDRAW_THRESHOLD,
+                                           unsigned int cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Reorders vertices in order of first use by indices, dropping unreferenced ones
+void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices);
+
+// Runs the vertex cache, overdraw and vertex fetch optimizations in order
+MeshOptimizationStats optimizeMesh(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices);
+
+inline float VertexCacheStats::getACMR() const {
+    return this->numTriangles == 0 ? 0.0f :
+                                     static_cast<float>(this->numTransformedVertices) / this->numTriangles;
+}
+
+inline float VertexCacheStats::getATVR() const {
+    return this->numVertices == 0 ? 0.0f :
+                                    static_cast<float>(this->numTransformedVertices) / this->numVertices;
+}
+
+inline VertexCacheStats &VertexCacheStats::operator+=(const VertexCacheStats &other) {
+    this->numTriangles += other.numTriangles;
+    this->numVertices += other.numVertices;
+    this->numTransformedVertices += other.numTransformedVertices;
+    return *this;
+}
+
+} // namespace lgl
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace lgl {
+
+struct Vertex;
+
+struct LodSettings {
+    unsigned int maxNumLods = 1;     // Including the full detail level
+    float triangleRatio = 0.5f;      // Triangles kept by each level relative to the previous one
+};
+
+struct LodLevel {
+    std::vector<unsigned int> indices;
+    float error;                     // Largest deviation from the full detail mesh, in model units
+};
+
+// Quadric error metric edge collapse simplification. Vertices are left in
+// place and only the indices referencing them change. Border and attribute
+// seam vertices are never moved, so simplification can stop short of
+// targetNumIndices. error receives the largest deviation introduced.
+std::vector<unsigned int> simplifyMesh(const std::vector<Vertex> &vertices,
+                                       const std::vector<unsigned int> &indices,
+                                       std::size_t targetNumIndices,
+                                       float *error);
+
+// Simplifies indices into progressively coarser levels, stopping early once
+// a level no longer removes a meaningful number of triangles
+std::vector<LodLevel> generateLods(const std::vector<Vertex> &vertices,
+                                   const std::vector<unsigned int> &indices,
+                                   const LodSettings &settings);
+
+// Relative width of the band around the maximum error in which selectLod()
+// keeps the current level
+constexpr float LOD_HYSTERESIS = 0.25f;
+
+// Switches from currentLod to the coarsest of numLods levels whose
+// getError(lod) stays below maxError, with level 0 the full detail. Levels
+// only change once the error leaves the band of LOD_HYSTERESIS around
+// maxError, so that they don't flicker back and forth.
+template <typename GetError>
+std::size_t selectLod(std::size_t numLods, std::size_t currentLod, float maxError, GetError getError) {
+    while (currentLod > 0 && getError(currentLod) > maxError * (1.0f + LOD_HYSTERESIS)) {
+        --currentLod;
+    }
+    while (currentLod + 1 < numLods && getError(currentLod + 1) < maxError * (1.0f - LOD_HYSTERESIS)) {
+        ++currentLod;
+    }
+    return currentLod;
+}
+
+} // namespace lgl
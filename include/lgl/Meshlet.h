@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+namespace lgl {
+
+struct Vertex;
+
+struct MeshletSettings {
+    unsigned int maxTriangles = 0;   // 0 disables meshlets
+    unsigned int maxVertices = 64;
+};
+
+// Consecutive range of triangles in an index buffer with bounds for culling
+struct Meshlet {
+    std::size_t firstIndex;
+    std::size_t numIndices;
+
+    glm::vec3 center;
+    float radius;
+
+    // All triangle normals lie within acos(sqrt(1 - coneCutoff^2)) of
+    // coneAxis. A cutoff of 1 never culls.
+    glm::vec3 coneAxis;
+    float coneCutoff;
+};
+
+// Splits indices into meshlets in their current order, so triangles should
+// be ordered for locality first, e.g. by optimizeVertexCache()
+std::vector<Meshlet> buildMeshlets(const std::vector<Vertex> &vertices,
+                                   const std::vector<unsigned int> &indices,
+                                   const MeshletSettings &settings);
+
+// True if every triangle of meshlet faces away from cameraPosition
+bool isBackfacing(const Meshlet &meshlet, const glm::vec3 &cameraPosition);
+
+} // namespace lgl
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "GeometryPool.h"
+#include "GlHandle.h"
+
+namespace lgl {
+
+class Mesh;
+class ShaderProgram;
+
+// Draws meshes of one geometry pool with one glMultiDrawElementsIndirect per
+// material, so that submission cost scales with materials rather than
+// meshes. The transforms of each draw go to a buffer texture that a vertex
+// shader with MULTI_DRAW defined reads through a draw id attribute, offset by
+// each command's base instance. Without GL 4.3 the same data is drawn with
+// one call per mesh.
+class MultiDrawBatch {
+public:
+    // Of the last render()
+    struct Stats {
+        std::size_t numDraws = 0;
+        std::size_t numCalls = 0;
+    };
+
+    MultiDrawBatch();
+
+    // Whether the current context has glMultiDrawElementsIndirect
+    static bool isIndirectSupported();
+
+    // Turning indirect draws off forces the fallback, e.g. for comparison
+    void setIndirectEnabled(bool isEnabled);
+
+    // The mesh must come from the same geometry pool as the others and stay
+    // alive until render()
+    void add(Mesh *mesh, const glm::mat4 &model, const glm::mat3 &normal);
+
+    // Draws and then removes all meshes. The shader program must be in use.
+    void render(ShaderProgram *shaderProgram);
+    void clear();
+
+    std::size_t getSize() const;
+    Stats getStats() const;
+
+private:
+    struct Draw {
+        Mesh *mesh;
+        glm::mat4 model;
+        glm::mat3 normal;
+    };
+
+    void upload();
+
+    std::vector<Draw> draws;
+    std::vector<unsigned int> drawOrder;
+    std::vector<glm::vec4> drawData;
+    std::vector<GeometryPool::DrawCommand> commands;
+
+    BufferHandle drawDataBuffer;
+    TextureHandle drawDataTexture;
+    BufferHandle drawIdBuffer;
+    std::size_t drawIdCapacity = 0;
+    BufferHandle commandBuffer;
+    bool isIndirectEnabled = true;
+    Stats stats;
+};
+
+inline void MultiDrawBatch::setIndirectEnabled(bool isEnabled) { this->isIndirectEnabled = isEnabled; }
+inline std::size_t MultiDrawBatch::getSize() const { return this->draws.size(); }
+inline MultiDrawBatch::Stats MultiDrawBatch::getStats() const { return this->stats; }
+
+} // namespace lgl
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "AabbTree.h"
+#include "Camera.h"
+#include "Frustum.h"
+
+namespace lgl {
+
+class GameObject;
+
+// Keeps the world bounds of objects in a dynamic AABB tree and returns those
+// the camera can see. Objects provide getWorldBounds() and a
+// getTransformVersion() that changes whenever their bounds may have, like
+// GameObject does.
+template <typename Object>
+class BasicObjectCuller {
+public:
+    using Stats = AabbTree::QueryStats;
+
+    // The object must stay alive until it is removed
+    void add(Object *object) {
+        const auto entry = static_cast<unsigned int>(this->entries.size());
+        const auto proxy = this->tree.createProxy(object->getWorldBounds(), entry);
+        this->entries.push_back({object, proxy, object->getTransformVersion()});
+    }
+
+    void remove(Object *object) {
+        auto entry = std::find_if(this->entries.begin(), this->entries.end(),
+                                  [object](const auto &e){ return e.object == object; });
+        assert(("Only added objects can be removed", entry != this->entries.end()));
+
+        // Move the last entry into the hole
+        this->tree.destroyProxy(entry->proxy);
+        *entry = this->entries.back();
+        this->tree.setUserData(entry->proxy, static_cast<unsigned int>(entry - this->entries.begin()));
+        this->entries.pop_back();
+    }
+
+    // Refits objects whose transforms changed since the last update
+    void update() {
+        for (auto &entry : this->entries) {
+            if (entry.object->getTransformVersion() != entry.version) {
+                this->tree.moveProxy(entry.proxy, entry.object->getWorldBounds());
+                entry.version = entry.object->getTransformVersion();
+            }
+        }
+    }
+
+    // Updates and returns the objects whose bounds intersect frustum, valid
+    // until the next call
+    const std::vector<Object *> &cull(const Frustum &frustum) {
+        this->update();
+
+        this->stats = Stats();
+        this->visibleEntries.clear();
+        this->tree.query(frustum, this->visibleEntries, &this->stats);
+
+        this->visibleObjects.resize(this->visibleEntries.size());
+        std::transform(this->visibleEntries.cbegin(), this->visibleEntries.cend(), this->visibleObjects.begin(),
+                       [this](const auto i){ return this->entries[i].object; });
+        return this->visibleObjects;
+    }
+
+    const std::vector<Object *> &cull(const Camera &camera) {
+        return this->cull(Frustum(camera.getProjectionMatrix() * camera.getViewMatrix()));
+    }
+
+    // Of the last cull()
+    Stats getStats() const { return this->stats; }
+    std::size_t getNumObjects() const { return this->entries.size(); }
+
+private:
+    struct Entry {
+        Object *object;
+        AabbTree::ProxyId proxy;
+        unsigned long version;
+    };
+
+    AabbTree tree;
+    std::vector<Entry> entries;
+    std::vector<unsigned int> visibleEntries;
+    std::vector<Object *> visibleObjects;
+    Stats stats;
+};
+
+using ObjectCuller = BasicObjectCuller<GameObject>;
+
+} // namespace lgl
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "Aabb.h"
+
+namespace lgl {
+
+// Triangles of a closed mesh, counter clockwise when seen from outside
+struct OccluderMesh {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+};
+
+// Rasterizes occluders into a low resolution depth buffer on the CPU and
+// tests bounding boxes against it, so that objects hidden behind closer
+// geometry are never submitted. Each triangle is set up once and binned into
+// the screen tiles it overlaps, then tiles are rasterized in parallel threads,
+// four pixels at a time with SSE.
+//
+// Per frame: beginFrame(), addOccluder() for each occluder, rasterize(),
+// then isVisible() for each object.
+class OcclusionCuller {
+public:
+    // Occluder triangles rasterized vs. boxes tested and found hidden
+    struct Stats {
+        unsigned long numOccluderTriangles = 0;
+        unsigned long numTested = 0;
+        unsigned long numOccluded = 0;
+    };
+
+    // width is rounded up to a multiple of 4. numThreads of 0 uses one
+    // thread per hardware thread.
+    explicit OcclusionCuller(unsigned int width = 256, unsigned int height = 128,
+                             unsigned int numThreads = 0);
+
+    // Clears the depth buffer and the occluders
+    void beginFrame(const glm::mat4 &viewProjectionMatrix);
+
+    // Transforms, clips and culls the occluder's triangles. Triangles with a
+    // corner in front of the near plane are dropped, which only lets more
+    // through.
+    void addOccluder(const OccluderMesh &occluder, const glm::mat4 &modelMatrix);
+
+    void rasterize();
+
+    // False only if the box lies behind the rasterized occluders in every
+    // pixel it covers, or outside the view
+    bool isVisible(const Aabb &worldBounds);
+
+    unsigned int getWidth() const;
+    unsigned int getHeight() const;
+
+    // Row major from the bottom left, 0 at the near plane and 1 at the far
+    // plane
+    const std::vector<float> &getDepthBuffer() const;
+
+    // Since the last beginFrame()
+    Stats getStats() const;
+
+private:
+    // Screen space x, y and depth of the corners
+    struct Triangle {
+        glm::vec3 corners[3];
+    };
+
+    // Edge function a * x + b * y + c, positive inside a counter clockwise triangle
+    struct Edge {
+        float a, b, c;
+    };
+
+    // Triangle as the tiles rasterize it, with depth interpolated like an
+    // edge function and the pixels whose centers it may cover
+    struct RasterTriangle {
+        Edge edges[3];
+        Edge depth;
+        int firstX, firstY, endX, endY;
+    };
+
+    static Edge getEdge(const glm::vec3 &from, const glm::vec3 &to);
+
+    void setupTriangles();
+    void rasterizeTile(unsigned int tile);
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int numThreads;
+    glm::mat4 viewProjectionMatrix{1.0f};
+    std::vector<float> depthBuffer;
+    std::vector<Triangle> triangles;
+    std::vector<RasterTriangle> rasterTriangles;
+
+    // Indices into rasterTriangles of the triangles overlapping each tile,
+    // row major from the bottom left
+    unsigned int numTilesX;
+    unsigned int numTilesY;
+    std::vector<std::vector<unsigned int>> tileTriangles;
+    Stats stats;
+};
+
+inline unsigned int OcclusionCuller::getWidth() const { return this->width; }
+inline unsigned int OcclusionCuller::getHeight() const { return this->height; }
+inline const std::vector<float> &OcclusionCuller::getDepthBuffer() const { return this->depthBuffer; }
+inline OcclusionCuller::Stats OcclusionCuller::getStats() const { return this->stats; }
+
+} // namespace lgl
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace lgl {
+
+// Number of threads used when a caller asks for 0
+unsigned int getDefaultNumThreads();
+
+// Splits [0, count) into chunks of chunkSize and calls function(begin, end)
+// on each, from up to numThreads threads including the calling one. Chunks
+// are handed out as threads finish, so uneven chunks still balance. Returns
+// once all chunks are done. The other threads come from a pool that is
+// started on first use and reused by later calls.
+void parallelFor(std::size_t count, std::size_t chunkSize,
+                 const std::function<void(std::size_t, std::size_t)> &function,
+                 unsigned int numThreads = 0);
+
+} // namespace lgl
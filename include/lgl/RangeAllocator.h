@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace lgl {
+
+// First fit allocator of ranges within [0, capacity) of something stored
+// elsewhere, such as the elements of a GPU buffer. Free ranges are kept sorted
+// by offset and merged with their neighbours when freed.
+class RangeAllocator {
+public:
+    struct Range {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    explicit RangeAllocator(std::size_t capacity = 0);
+
+    // Sets offset to the start of the first free range large enough and
+    // returns whether there was one. Empty ranges always succeed at offset 0.
+    bool allocate(std::size_t size, std::size_t *offset);
+
+    void free(Range range);
+
+    // Frees the ranges added at the end
+    void grow(std::size_t capacity);
+
+    // Frees everything after the first size elements, as after moving all
+    // allocations to the front
+    void reset(std::size_t size);
+
+    std::size_t getCapacity() const;
+    std::size_t getNumFree() const;
+    const std::vector<Range> &getFreeRanges() const;
+
+private:
+    std::vector<Range> freeRanges;
+    std::size_t capacity = 0;
+};
+
+inline std::size_t RangeAllocator::getCapacity() const { return this->capacity; }
+inline const std::vector<RangeAllocator::Range> &RangeAllocator::getFreeRanges() const { return this->freeRanges; }
+
+} // namespace lgl
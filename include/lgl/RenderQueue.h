@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "CommandList.h"
+
+namespace lgl {
+
+class Mesh;
+class ShaderProgram;
+class UniformRingBuffer;
+
+// Collects draws for a frame and executes them sorted by their CommandList
+// keys, so that draws sharing a shader program, material and vertex array run
+// back to back and each piece of state is changed only when it differs from
+// the previous draw. Draws come from the queue's own command list or from
+// lists recorded on worker threads by record(). Per draw uniforms go through
+// a UniformRingBuffer, so programs need DRAW_UNIFORM_BLOCK.
+class RenderQueue {
+public:
+    static constexpr unsigned int MAX_NUM_PASSES = CommandList::MAX_NUM_PASSES;
+
+    // State changes made by the last execute()
+    struct Stats {
+        std::size_t numCommands = 0;
+        std::size_t numProgramSwitches = 0;
+        std::size_t numMaterialSwitches = 0;
+        std::size_t numVertexArraySwitches = 0;
+    };
+
+    // Into the queue's own command list, see CommandList::submit()
+    void submit(unsigned int pass, ShaderProgram *shaderProgram, Mesh *mesh,
+                const glm::mat4 &model, const glm::mat3 &normal, float depth);
+
+    CommandList &getCommandList();
+
+    // Splits [0, count) into chunks of chunkSize and calls
+    // function(commandList, begin, end) on each from up to numThreads threads
+    // like parallelFor(). A chunk records into a list no other running chunk
+    // uses, so there are only about as many lists as threads, and the merge
+    // puts chunks back in order, so draws with equal keys don't depend on how
+    // chunks were spread over threads. function must not make GL calls.
+    void record(std::size_t count, std::size_t chunkSize,
+                const std::function<void(CommandList &, std::size_t, std::size_t)> &function,
+                unsigned int numThreads = 0);
+
+    // Merges all command lists, writes a DrawUniformBlock per draw into
+    // uniformRingBuffer at once, draws binding each block's range and then
+    // clears the lists. Needs a begun ring buffer frame, which grows if the
+    // draws don't fit.
+    void execute(UniformRingBuffer &uniformRingBuffer);
+
+    // Merges all command lists and returns their packets in the order
+    // execute() would draw them, without making GL calls
+    std::vector<const CommandList::Packet *> getSortedPackets();
+
+    void clear();
+
+    std::size_t getSize() const;
+    Stats getStats() const;
+
+private:
+    struct SortEntry {
+        std::uint64_t key;
+        const CommandList::Packet *packet;
+    };
+
+    // Packets [begin, end) of list were recorded by the chunk-th record() chunk
+    struct RecordedChunk {
+        std::size_t chunk;
+        const CommandList *list;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    CommandList *acquireList();
+    void releaseList(CommandList *list, const RecordedChunk &recordedChunk);
+    void merge();
+    void sort();
+
+    CommandList commandList;
+
+    // Lists of record(), kept across frames. Those in freeLists aren't used
+    // by a running chunk. Both are guarded by mutex during record().
+    std::vector<std::unique_ptr<CommandList>> recordedLists;
+    std::vector<CommandList *> freeLists;
+    std::vector<RecordedChunk> recordedChunks;
+    std::size_t numRecordedChunks = 0;
+    std::mutex mutex;
+
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> sortBuffer;
+    std::vector<std::size_t> drawUniformOffsets;
+    Stats stats;
+};
+
+inline CommandList &RenderQueue::getCommandList() { return this->commandList; }
+inline RenderQueue::Stats RenderQueue::getStats() const { return this->stats; }
+
+} // namespace lgl
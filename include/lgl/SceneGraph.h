@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace lgl {
+
+// Hierarchy of transforms. Changing a node's local transform marks it dirty,
+// and update() recomputes the cached world transforms and normal matrices
+// of dirty nodes and everything below them only.
+class SceneGraph {
+public:
+    using NodeId = unsigned int;
+
+    // Parent of all other nodes, and its own parent
+    static constexpr NodeId ROOT_NODE = 0;
+
+    SceneGraph();
+
+    NodeId createNode(NodeId parent, const glm::mat4 &localTransform = glm::mat4(1.0f));
+    void setParent(NodeId node, NodeId parent);
+    void setLocalTransform(NodeId node, const glm::mat4 &localTransform);
+
+    std::size_t getNumNodes() const;
+    NodeId getParent(NodeId node) const;
+    const std::vector<NodeId> &getChildren(NodeId node) const;
+    const glm::mat4 &getLocalTransform(NodeId node) const;
+    bool isDirty(NodeId node) const;
+
+    // Changes whenever a node is created, moved or reparented
+    unsigned long getVersion() const;
+
+    // Up to date as of the last update()
+    const glm::mat4 &getWorldTransform(NodeId node) const;
+    const glm::mat3 &getNormalMatrix(NodeId node) const;
+
+    // Breadth first pass over the dirty subtrees. Returns the number of nodes
+    // recomputed.
+    std::size_t update();
+
+private:
+    void markDirty(NodeId node);
+
+    std::vector<NodeId> parents;
+    std::vector<std::vector<NodeId>> children;
+    std::vector<glm::mat4> localTransforms;
+    std::vector<glm::mat4> worldTransforms;
+    std::vector<glm::mat3> normalMatrices;
+    std::vector<bool> isNodeDirty;
+    unsigned long version = 0;
+
+    // Nodes marked dirty since the last update and the update's work queue
+    std::vector<NodeId> dirtyNodes;
+    std::vector<NodeId> updateQueue;
+};
+
+inline std::size_t SceneGraph::getNumNodes() const { return this->parents.size(); }
+inline SceneGraph::NodeId SceneGraph::getParent(NodeId node) const { return this->parents[node]; }
+inline const std::vector<SceneGraph::NodeId> &SceneGraph::getChildren(NodeId node) const { return this->children[node]; }
+inline const glm::mat4 &SceneGraph::getLocalTransform(NodeId node) const { return this->localTransforms[node]; }
+inline bool SceneGraph::isDirty(NodeId node) const { return this->isNodeDirty[node]; }
+inline unsigned long SceneGraph::getVersion() const { return this->version; }
+inline const glm::mat4 &SceneGraph::getWorldTransform(NodeId node) const { return this->worldTransforms[node]; }
+inline const glm::mat3 &SceneGraph::getNormalMatrix(NodeId node) const { return this->normalMatrices[node]; }
+
+} // namespace lgl
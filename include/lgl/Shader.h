@@ -1,18 +1,23 @@
 #pragma once
 
-#include <memory>
+#include <map>
 #include <string>
 
+#include "GlHandle.h"
+
 namespace lgl {
 
+// Macro name -> replacement text injected as #define directives after #version
+using ShaderDefines = std::map<std::string, std::string>;
+
 class Shader {
 public:
-    Shader(const std::string &pathname, int type);
+    Shader(const std::string &pathname, int type, const ShaderDefines &defines = {});
     void attachToShaderProgram(unsigned int program);
     void detachFromShaderProgram(unsigned int program);
 
 private:
-    std::unique_ptr<unsigned int, void(*)(unsigned int *)> shader;
+    ShaderHandle shader;
 };
 
 } // namespace lgl
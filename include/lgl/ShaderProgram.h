@@ -1,17 +1,28 @@
 #pragma once
 
-#include <memory>
+#include <array>
 #include <string>
+#include <unordered_map>
 
 #include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
 
+#include "GlHandle.h"
+#include "Shader.h"
+
 namespace lgl {
 
 class ShaderProgram {
 public:
+    // Number of glUniform* calls made vs. skipped because the value was unchanged
+    struct UniformStats {
+        unsigned long numIssued = 0;
+        unsigned long numSkipped = 0;
+    };
+
     ShaderProgram(const std::string &vertexShaderPathname,
-                  const std::string &fragmentShaderPathname);
+                  const std::string &fragmentShaderPathname,
+                  const ShaderDefines &defines = {});
 
     void use() const;
 
@@ -22,8 +33,43 @@ public:
     void setUniform(const std::string &name, const glm::mat3 &value);
     void setUniform(const std::string &name, const glm::mat4 &value);
 
+    // Texture unit assigned to a sampler uniform at link time, or -1 if the
+    // program has no active sampler with that name
+    int getTextureUnit(const std::string &samplerName) const;
+
+    // Binding point assigned to a uniform block at link time, or -1 if the
+    // program has no active block with that name
+    int getUniformBlockBinding(const std::string &blockName) const;
+
+    UniformStats getUniformStats() const;
+    void resetUniformStats();
+
+    unsigned int getId() const;
+
 private:
-    std::unique_ptr<unsigned int, void(*)(unsigned int *)> program;
+    // CPU-side copy of the value last uploaded to a uniform
+    struct Uniform {
+        int location;
+        bool isSampler = false;
+        bool isSet = false;
+        std::array<unsigned char, sizeof(glm::mat4)> value;
+    };
+
+    void loadActiveUniforms();
+    void loadUniformBlocks();
+    void assignTextureUnit(const std::string &samplerName, int textureUnit);
+
+    template<typename T>
+    Uniform *updateUniform(const std::string &name, const T &value);
+
+    ProgramHandle program;
+    std::unordered_map<std::string, Uniform> uniforms;
+    std::unordered_map<std::string, int> uniformBlockBindings;
+    UniformStats uniformStats;
 };
 
+inline ShaderProgram::UniformStats ShaderProgram::getUniformStats() const { return this->uniformStats; }
+inline void ShaderProgram::resetUniformStats() { this->uniformStats = UniformStats(); }
+inline unsigned int ShaderProgram::getId() const { return this->program.get(); }
+
 } // namespace lgl
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "Shader.h"
+#include "ShaderProgram.h"
+
+namespace lgl {
+
+// Compiles and links specialized programs of a vertex/fragment shader pair,
+// one per distinct set of defines, the first time each set is requested.
+class ShaderVariantCache {
+public:
+    ShaderVariantCache(const std::string &vertexShaderPathname,
+                       const std::string &fragmentShaderPathname);
+
+    ShaderProgram *getVariant(const ShaderDefines &defines);
+    std::size_t getNumVariants() const;
+
+private:
+    std::string vertexShaderPathname;
+    std::string fragmentShaderPathname;
+    std::map<ShaderDefines, ShaderProgram> variants;
+};
+
+inline std::size_t ShaderVariantCache::getNumVariants() const { return this->variants.size(); }
+
+} // namespace lgl
@@ -1,18 +1,26 @@
 #pragma once
 
-#include <memory>
 #include <string>
 
 namespace lgl {
 
+struct SharedTexture;
+
+// Textures loaded from the same pathname share one GL texture, which is
+// deleted with the last Texture2D referencing it
 class Texture2D {
 public:
     explicit Texture2D(const std::string &pathname);
+    Texture2D(const Texture2D &other);
+    Texture2D(Texture2D &&other) noexcept;
+    Texture2D &operator=(Texture2D other) noexcept;
+    ~Texture2D();
 
     void bind();
+    unsigned int getId() const;
 
 private:
-    std::shared_ptr<unsigned int> texture;
+    SharedTexture *texture;
 };
 
 } // namespace lgl
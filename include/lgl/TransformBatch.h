@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace lgl {
+
+class Frame;
+
+// Per instance attributes as laid out in an instance buffer
+struct InstanceTransform {
+    glm::mat4 model;
+    glm::mat3 normal;
+};
+
+// Per draw data in the std140 layout of the DrawUniforms block in
+// shaders/draw_uniforms.glsl, which DRAW_UNIFORM_BLOCK enables. Each mat3
+// column takes a vec4, and the shine fills the vec4 of the position scale.
+struct DrawUniformBlock {
+    // For draws without compact vertices or a material, like the light cubes
+    DrawUniformBlock(const glm::mat4 &model, const glm::mat3 &normal);
+
+    // With a mesh's compact position scale and offset and its material's shine
+    DrawUniformBlock(const glm::mat4 &model, const glm::mat3 &normal,
+                     const glm::vec3 &positionScale, const glm::vec3 &positionOffset, float shine);
+
+    glm::mat4 model;
+    glm::vec4 normal[3];
+    glm::vec3 positionScale;
+    float shine;
+    glm::vec4 positionOffset;
+};
+
+// Positions, orientations and scales of many objects in structure of arrays
+// layout, so that their model and normal matrices are computed four at a time
+// with SSE. Orientations are unit quaternions. Normal matrices come in closed
+// form from the orientation and the inverse scale rather than from a general
+// inverse.
+class TransformBatch {
+public:
+    using Index = unsigned int;
+
+    TransformBatch() = default;
+
+    // Copies and moves take a new version, as both change the contents the
+    // destination held before
+    TransformBatch(const TransformBatch &other);
+    TransformBatch(TransformBatch &&other);
+    TransformBatch &operator=(const TransformBatch &other);
+    TransformBatch &operator=(TransformBatch &&other);
+
+    Index add(const Frame &frame);
+    Index add(const glm::vec3 &position, const glm::quat &orientation, const glm::vec3 &scale);
+
+    void set(Index i, const Frame &frame);
+    void setPosition(Index i, const glm::vec3 &position);
+    void setOrientation(Index i, const glm::quat &orientation);
+    void setScale(Index i, const glm::vec3 &scale);
+
+    std::size_t getSize() const;
+    void clear();
+
+    // Changes whenever an object is added, changed or removed. Versions come
+    // from a counter shared by all batches, so no two states of any batches
+    // ever have the same version.
+    unsigned long getVersion() const;
+
+    // Writes getSize() transforms to output, which may point into a mapped
+    // buffer
+    void computeTransforms(InstanceTransform *output) const;
+
+    // Replaces the contents of buffer with the transforms of all objects
+    void writeInstanceBuffer(unsigned int buffer) const;
+
+private:
+    static unsigned long getNextVersion();
+
+    std::vector<float> positions[3];
+    std::vector<float> orientations[4];     // x, y, z, w
+    std::vector<float> scales[3];
+    unsigned long version = getNextVersion();
+};
+
+inline std::size_t TransformBatch::getSize() const { return this->positions[0].size(); }
+inline unsigned long TransformBatch::getVersion() const { return this->version; }
+
+} // namespace lgl
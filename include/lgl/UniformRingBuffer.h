@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+#include "GlHandle.h"
+
+namespace lgl {
+
+// Streams per draw data into one uniform buffer split into a region per
+// frame in flight. A fence marks when the GPU is done with a region, and only
+// then is it written again. With GL 4.4 the buffer stays mapped persistently
+// and coherently, otherwise written ranges are mapped unsynchronized and
+// flushed explicitly. A frame that outgrows its region reallocates the
+// buffer with larger regions rather than failing.
+//
+// Per frame: beginFrame(), then any number of write()s followed by flush()
+// before drawing with what they wrote, then endFrame().
+class UniformRingBuffer {
+public:
+    static constexpr std::size_t NUM_FRAMES = 3;
+
+    struct Stats {
+        unsigned long numFrames = 0;
+
+        // Frames that waited for the GPU to release their region, and for how long
+        unsigned long numStalls = 0;
+        std::chrono::duration<float> stallTime{0.0f};
+
+        // Most bytes written in one frame, including alignment
+        std::size_t maxFrameBytes = 0;
+
+        // Times a frame's region was full and the buffer was reallocated larger
+        unsigned long numGrowths = 0;
+
+        // Frames that gave up waiting for the GPU and reused their region anyway
+        unsigned long numFenceTimeouts = 0;
+    };
+
+    // Room for frameSize bytes per frame. Needs a current context.
+    explicit UniformRingBuffer(std::size_t frameSize = 1u << 20);
+    ~UniformRingBuffer();
+
+    UniformRingBuffer(const UniformRingBuffer &) = delete;
+    UniformRingBuffer &operator=(const UniformRingBuffer &) = delete;
+
+    void beginFrame();
+    void endFrame();
+
+    // Reserves size bytes aligned for glBindBufferRange() and returns where
+    // to write them. offset is relative to the frame's region, so it stays
+    // valid for bindRange() until endFrame() even if the buffer grows.
+    void *allocate(std::size_t size, std::size_t *offset);
+
+    // Copies value in and sets offset to it like allocate()
+    template <typename T>
+    void write(const T &value, std::size_t *offset);
+
+    // Makes everything written since the last flush visible to draws
+    void flush();
+
+    // Binds size bytes at offset of the current frame
+    void bindRange(unsigned int bindingIndex, std::size_t offset, std::size_t size) const;
+
+    bool isPersistent() const;
+    std::size_t getFrameSize() const;
+
+    // Fraction of the frame size the fullest frame used
+    float getUtilization() const;
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    void createStorage();
+    void grow(std::size_t minFrameSize);
+
+    BufferHandle buffer;
+    std::size_t frameSize;
+    std::size_t alignment;
+    std::array<void *, NUM_FRAMES> fences{};
+    std::size_t frame = NUM_FRAMES - 1;
+    std::size_t head = 0;
+    bool isInFrame = false;
+
+    // Whole buffer while persistent, else the range mapped since the last flush
+    unsigned char *mappedData = nullptr;
+    std::size_t mappedOffset = 0;
+    bool isPersistentlyMapped = false;
+
+    std::size_t frameBytes = 0;
+    Stats stats;
+};
+
+template <typename T>
+void UniformRingBuffer::write(const T &value, std::size_t *offset) {
+    std::memcpy(this->allocate(sizeof(T), offset), &value, sizeof(T));
+}
+
+inline bool UniformRingBuffer::isPersistent() const { return this->isPersistentlyMapped; }
+inline std::size_t UniformRingBuffer::getFrameSize() const { return this->frameSize; }
+inline float UniformRingBuffer::getUtilization() const { return static_cast<float>(this->stats.maxFrameBytes) / this->frameSize; }
+inline UniformRingBuffer::Stats UniformRingBuffer::getStats() const { return this->stats; }
+inline void UniformRingBuffer::resetStats() { this->stats = Stats(); }
+
+} // namespace lgl
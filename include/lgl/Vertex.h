@@ -1,10 +1,21 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
 namespace lgl {
 
+enum class VertexFormat {
+    Float,  // Vertex as is: 32 bytes
+    Compact,// CompactVertex: 16 bytes, needs COMPACT_VERTICES in the vertex shader
+    Split   // Vertex split into 12 byte positions and 20 byte VertexAttributes
+            // streams, so that depth only passes fetch positions alone
+};
+
 struct Vertex {
     Vertex(glm::vec3 postion,
            glm::vec3 normal,
@@ -15,4 +26,51 @@ struct Vertex {
     glm::vec2 textureCoordinates;
 };
 
+struct CompactVertex {
+    std::uint16_t position[3];          // Unsigned normalized against the mesh bounds
+    std::uint16_t padding;
+    std::uint32_t normal;               // GL_INT_2_10_10_10_REV
+    std::uint32_t textureCoordinates;   // 2 x half float
+};
+
+// Second stream of VertexFormat::Split
+struct VertexAttributes {
+    glm::vec3 normal;
+    glm::vec2 textureCoordinates;
+};
+
+std::size_t getVertexSize(VertexFormat vertexFormat);
+
+// Quantizes positions to [0, 1] via (position - positionOffset) / positionScale
+std::vector<CompactVertex> compressVertices(const std::vector<Vertex> &vertices,
+                                            const glm::vec3 &positionScale,
+                                            const glm::vec3 &positionOffset);
+
+std::vector<glm::vec3> getPositionStream(const std::vector<Vertex> &vertices);
+std::vector<VertexAttributes> getAttributeStream(const std::vector<Vertex> &vertices);
+
+// Points the attributes of the bound vertex array at the bound GL_ARRAY_BUFFER.
+// VertexFormat::Split needs the two calls below instead.
+void setVertexAttributes(VertexFormat vertexFormat);
+
+// Points the position attribute at the bound GL_ARRAY_BUFFER of positions
+void setPositionStreamAttributes();
+
+// Points the remaining attributes at the bound GL_ARRAY_BUFFER of VertexAttributes
+void setAttributeStreamAttributes();
+
+// Points the per instance attributes from location 3 on at the bound
+// GL_ARRAY_BUFFER of InstanceTransforms, advancing once per instance
+void setInstanceAttributes();
+
+// Undoes setInstanceAttributes() on the bound vertex array
+void disableInstanceAttributes();
+
+// Points the draw id attribute at location 10 at the bound GL_ARRAY_BUFFER of
+// unsigned ints, starting at firstDrawId and advancing once per instance
+void setDrawIdAttribute(std::size_t firstDrawId = 0);
+
+// Undoes setDrawIdAttribute() on the bound vertex array
+void disableDrawIdAttribute();
+
 } // namespace lgl
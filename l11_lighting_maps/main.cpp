@@ -10,6 +10,7 @@
 #include <glm/glm.hpp>
 
 #include <lgl/Camera.h>
+#include <lgl/GlState.h>
 #include <lgl/ShaderProgram.h>
 #include <lgl/Texture2D.h>
 
@@ -58,7 +59,7 @@ int main(int argc, char *argv[]) {
 
     // Initialize OpenGL settings
     glViewport(0, 0, windowWidth, windowHeight);
-    glEnable(GL_DEPTH_TEST);
+    lgl::GlState::setEnabled(GL_DEPTH_TEST, true);
 
     {
         // Create shaders
@@ -115,7 +116,7 @@ int main(int argc, char *argv[]) {
 
         unsigned int vao;
         glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
+        lgl::GlState::bindVertexArray(vao);
 
         unsigned int vbo;
         glGenBuffers(1, &vbo);
@@ -139,7 +140,7 @@ int main(int argc, char *argv[]) {
         // Setup light
         unsigned int lightVao;
         glGenVertexArrays(1, &lightVao);
-        glBindVertexArray(lightVao);
+        lgl::GlState::bindVertexArray(lightVao);
 
         glBindBuffer(GL_ARRAY_BUFFER, vao); // Use conatiner vbo
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, static_cast<void *>(0));
@@ -188,20 +189,20 @@ int main(int argc, char *argv[]) {
             shaderProgram.setUniform("model", frame.getModelMatrix());
             shaderProgram.setUniform("normal", frame.getNormalMatrix());
 
-            glActiveTexture(GL_TEXTURE0);
+            lgl::GlState::activeTexture(0);
             diffuseTexture.bind();
 
-            glActiveTexture(GL_TEXTURE1);
+            lgl::GlState::activeTexture(1);
             specularTexture.bind();
 
-            glBindVertexArray(vao);
+            lgl::GlState::bindVertexArray(vao);
             glDrawArrays(GL_TRIANGLES, 0, vertices.size());
 
             // Draw light
             lightShaderProgram.use();
             lightShaderProgram.setUniform("view_projection", view_projection_matrix);
             lightShaderProgram.setUniform("model", lightFrame.getModelMatrix());
-            glBindVertexArray(lightVao);
+            lgl::GlState::bindVertexArray(lightVao);
             glDrawArrays(GL_TRIANGLES, 0, vertices.size());
 
             glfwSwapBuffers(window);
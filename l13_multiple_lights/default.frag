@@ -1,5 +1,14 @@
 #version 330 core
 
+// Set by the application:
+//   DIRECTIONAL_LIGHT - enables the directional light
+//   NUM_POINT_LIGHTS  - number of point lights, compiled out when 0
+#ifndef NUM_POINT_LIGHTS
+#define NUM_POINT_LIGHTS 0
+#endif
+
+#include "../shaders/lighting.glsl"
+
 in vec3 fragNormal;
 in vec3 fragPosition;
 in vec2 texCoords;
@@ -12,77 +21,39 @@ struct Material {
     float shine;
 };
 
-struct Lighting {
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct DirectionalLight {
-    vec3 direction;
-    Lighting lighting;
-};
-
-struct PointLight {
-    vec3 position;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    Lighting lighting;
-};
-
-#define NUM_POINT_LIGHTS 4
 uniform Material material;
+#ifdef DIRECTIONAL_LIGHT
 uniform DirectionalLight directionalLight;
+#endif
+#if NUM_POINT_LIGHTS > 0
 uniform PointLight pointLights[NUM_POINT_LIGHTS];
+#endif
 uniform vec3 camPosition;
 
-vec3 calculateBaseLight(vec3 lightDirection, Lighting lighting);
-vec3 calculateDirectionalLight();
-vec3 calculatePointLight();
-
 void main() {
-    vec3 lighting = calculateDirectionalLight();
-    lighting += calculatePointLight();
-    fragColor = vec4(lighting, 1.0);
-}
-
-vec3 calculateBaseLight(vec3 lightDirection, Lighting lighting) {
-    // Diffuse lighting
     vec3 normal = normalize(fragNormal);
-    float diffuse = max(dot(normal, -lightDirection), 0.0);
-
-    // Specular lighting
     vec3 camDirection = normalize(camPosition - fragPosition);
-    vec3 reflectDirection = reflect(lightDirection, normal);
-    float specular = pow(max(dot(camDirection, reflectDirection), 0.0),
-                         material.shine);
-
     vec3 diffuseColor = vec3(texture(material.diffuse, texCoords));
     vec3 specularColor = vec3(texture(material.specular, texCoords));
 
-    return diffuseColor * lighting.ambient +
-        diffuse * diffuseColor * lighting.diffuse +
-        specular * specularColor * lighting.specular;
-}
+    vec3 lighting = vec3(0.0);
 
-vec3 calculateDirectionalLight() {
-    return calculateBaseLight(normalize(directionalLight.direction),
-                              directionalLight.lighting);
-}
+#ifdef DIRECTIONAL_LIGHT
+    lighting += calculateBaseLight(normalize(directionalLight.direction),
+                                   directionalLight.lighting,
+                                   normal, camDirection,
+                                   diffuseColor, specularColor, material.shine);
+#endif
 
-vec3 calculatePointLight() {
-    vec3 lighting = vec3(0.0);
+#if NUM_POINT_LIGHTS > 0
     for (int i = 0; i < NUM_POINT_LIGHTS; ++i) {
-        float distance = length(pointLights[i].position - fragPosition);
-        float attenuation = 1.0 / (pointLights[i].constant +
-                                   pointLights[i].linear * distance +
-                                   pointLights[i].quadratic * distance * distance);
         vec3 lightDirection = normalize(fragPosition - pointLights[i].position);
-        lighting += (calculateBaseLight(lightDirection, pointLights[i].lighting) *
-                     attenuation);
+        lighting += calculateBaseLight(lightDirection, pointLights[i].lighting,
+                                       normal, camDirection,
+                                       diffuseColor, specularColor, material.shine) *
+                calculateAttenuation(pointLights[i], fragPosition);
     }
-    return lighting;
+#endif
+
+    fragColor = vec4(lighting, 1.0);
 }
@@ -11,7 +11,9 @@
 #include <glm/glm.hpp>
 
 #include <lgl/Camera.h>
+#include <lgl/GlState.h>
 #include <lgl/ShaderProgram.h>
+#include <lgl/ShaderVariantCache.h>
 #include <lgl/Texture2D.h>
 
 using Clock = std::chrono::steady_clock;
@@ -59,11 +61,11 @@ int main(int argc, char *argv[]) {
 
     // Initialize OpenGL settings
     glViewport(0, 0, windowWidth, windowHeight);
-    glEnable(GL_DEPTH_TEST);
+    lgl::GlState::setEnabled(GL_DEPTH_TEST, true);
 
     {
         // Create shaders
-        lgl::ShaderProgram shaderProgram("default.vert", "default.frag");
+        lgl::ShaderVariantCache shaderVariants("default.vert", "default.frag");
         lgl::ShaderProgram lightShaderProgram("default.vert", "light.frag");
 
         // Setup cube vao
@@ -116,7 +118,7 @@ int main(int argc, char *argv[]) {
 
         unsigned int vao;
         glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
+        lgl::GlState::bindVertexArray(vao);
 
         unsigned int vbo;
         glGenBuffers(1, &vbo);
@@ -160,7 +162,7 @@ int main(int argc, char *argv[]) {
         // Setup light
         unsigned int lightVao;
         glGenVertexArrays(1, &lightVao);
-        glBindVertexArray(lightVao);
+        lgl::GlState::bindVertexArray(lightVao);
 
         glBindBuffer(GL_ARRAY_BUFFER, vao); // Use conatiner vbo
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, static_cast<void *>(0));
@@ -186,26 +188,32 @@ int main(int argc, char *argv[]) {
         cam->rotate(glm::radians(90.0f), {0.0f, 1.0f, 0.0f});
         cam->rotateInLocalFrame(glm::radians(-90.0f), {1.0f, 0.0f, 0.0f});
 
-        shaderProgram.use();
+        // Compile the lighting shader specialized for this scene's lights
+        auto shaderProgram = shaderVariants.getVariant({
+            {"DIRECTIONAL_LIGHT", ""},
+            {"NUM_POINT_LIGHTS", std::to_string(pointLightFrames.size())}
+        });
+
+        shaderProgram->use();
         lgl::Texture2D diffuseTexture("../textures/container2.png");
         lgl::Texture2D specularTexture("../textures/container2_specular.png");
-        shaderProgram.setUniform("material.diffuse", 0);
-        shaderProgram.setUniform("material.specular", 1);
-        shaderProgram.setUniform("material.shine", 32.0f);
+        shaderProgram->setUniform("material.diffuse", 0);
+        shaderProgram->setUniform("material.specular", 1);
+        shaderProgram->setUniform("material.shine", 32.0f);
 
-        shaderProgram.setUniform("directionalLight.direction", {-0.2f, -1.0f, -0.3f});
-        shaderProgram.setUniform("directionalLight.lighting.ambient", glm::vec3(0.2f));
-        shaderProgram.setUniform("directionalLight.lighting.diffuse", glm::vec3(0.5f));
-        shaderProgram.setUniform("directionalLight.lighting.specular", glm::vec3(1.0f));
+        shaderProgram->setUniform("directionalLight.direction", {-0.2f, -1.0f, -0.3f});
+        shaderProgram->setUniform("directionalLight.lighting.ambient", glm::vec3(0.2f));
+        shaderProgram->setUniform("directionalLight.lighting.diffuse", glm::vec3(0.5f));
+        shaderProgram->setUniform("directionalLight.lighting.specular", glm::vec3(1.0f));
 
         for (auto i = 0u; i < pointLightFrames.size(); ++i) {
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].position", pointLightFrames[i].getPosition());
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].constant", 1.0f);
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].linear", 0.09f);
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].quadratic", 0.032f);
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].lighting.ambient", glm::vec3(0.05f));
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].lighting.diffuse", glm::vec3(0.4f));
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].lighting.specular", glm::vec3(0.5f));
+            shaderProgram->setUniform("pointLights[" + std::to_string(i) + "].position", pointLightFrames[i].getPosition());
+            shaderProgram->setUniform("pointLights[" + std::to_string(i) + "].constant", 1.0f);
+            shaderProgram->setUniform("pointLights[" + std::to_string(i) + "].linear", 0.09f);
+            shaderProgram->setUniform("pointLights[" + std::to_string(i) + "].quadratic", 0.032f);
+            shaderProgram->setUniform("pointLights[" + std::to_string(i) + "].lighting.ambient", glm::vec3(0.05f));
+            shaderProgram->setUniform("pointLights[" + std::to_string(i) + "].lighting.diffuse", glm::vec3(0.4f));
+            shaderProgram->setUniform("pointLights[" + std::to_string(i) + "].lighting.specular", glm::vec3(0.5f));
         }
 
         auto lastUpdateTime = Clock::now();
@@ -221,22 +229,22 @@ int main(int argc, char *argv[]) {
             const auto view_projection_matrix = cam->getProjectionMatrix() * cam->getViewMatrix();
 
             // Draw cubes
-            shaderProgram.use();
+            shaderProgram->use();
             auto camPosition = cam->getPosition();
-            shaderProgram.setUniform("camPosition", camPosition);
-            shaderProgram.setUniform("view_projection", view_projection_matrix);
+            shaderProgram->setUniform("camPosition", camPosition);
+            shaderProgram->setUniform("view_projection", view_projection_matrix);
 
-            glActiveTexture(GL_TEXTURE0);
+            lgl::GlState::activeTexture(0);
             diffuseTexture.bind();
 
-            glActiveTexture(GL_TEXTURE1);
+            lgl::GlState::activeTexture(1);
             specularTexture.bind();
 
             for (const auto &f : frames) {
-                shaderProgram.setUniform("model", f.getModelMatrix());
-                shaderProgram.setUniform("normal", f.getNormalMatrix());
+                shaderProgram->setUniform("model", f.getModelMatrix());
+                shaderProgram->setUniform("normal", f.getNormalMatrix());
 
-                glBindVertexArray(vao);
+                lgl::GlState::bindVertexArray(vao);
                 glDrawArrays(GL_TRIANGLES, 0, vertices.size());
 
             }
@@ -246,7 +254,7 @@ int main(int argc, char *argv[]) {
                 lightShaderProgram.use();
                 lightShaderProgram.setUniform("view_projection", view_projection_matrix);
                 lightShaderProgram.setUniform("model", f.getModelMatrix());
-                glBindVertexArray(lightVao);
+                lgl::GlState::bindVertexArray(lightVao);
                 glDrawArrays(GL_TRIANGLES, 0, vertices.size());
             }
 
@@ -10,20 +10,192 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/glm.hpp>
 
+#include <lgl/Application.h>
 #include <lgl/Camera.h>
 #include <lgl/GameObject.h>
+#include <lgl/GeometryPool.h>
+#include <lgl/GlHandle.h>
+#include <lgl/GlState.h>
+#include <lgl/MultiDrawBatch.h>
+#include <lgl/ObjectCuller.h>
+#include <lgl/RenderQueue.h>
 #include <lgl/ShaderProgram.h>
+#include <lgl/ShaderVariantCache.h>
 #include <lgl/Texture2D.h>
-
-using Clock = std::chrono::steady_clock;
+#include <lgl/TransformBatch.h>
+#include <lgl/UniformRingBuffer.h>
 
 std::unique_ptr<lgl::Camera> cam;
 
+// Cycled through with Q
+enum class DrawPath {
+    RenderQueue,    // Sorted render queue
+    MultiDraw,      // One indirect multi draw per material
+    Meshlets        // Meshlet culled draws
+};
+auto drawPath = DrawPath::RenderQueue;
+
 static void frameBufferSizeCallback(GLFWwindow *window, int width, int height);
 static void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
 static void cursorPosCallback(GLFWwindow *window, double x, double y);
 static void scrollCallback(GLFWwindow *window, double xOffset, double yOffset);
 
+// Steps the camera in fixed timesteps and draws a row of nanosuits lit by
+// point lights, with the draw path selected by Q
+class NanosuitScene : public lgl::Application {
+public:
+    NanosuitScene(GLFWwindow *window, lgl::ObjectCuller &objectCuller,
+                  lgl::ShaderProgram *shaderProgram, lgl::ShaderProgram *queueShaderProgram,
+                  lgl::ShaderProgram *multiDrawShaderProgram,
+                  lgl::ShaderProgram &lightShaderProgram, unsigned int lightVao, std::size_t numLightVertices,
+                  const std::vector<lgl::Frame> &pointLightFrames) :
+        window(window), objectCuller(objectCuller),
+        shaderProgram(shaderProgram), queueShaderProgram(queueShaderProgram),
+        multiDrawShaderProgram(multiDrawShaderProgram),
+        lightShaderProgram(lightShaderProgram), lightVao(lightVao), numLightVertices(numLightVertices),
+        pointLightFrames(pointLightFrames),
+        uniformRingBuffer(64 * 1024),
+        lightBinding(static_cast<unsigned int>(lightShaderProgram.getUniformBlockBinding("DrawUniforms"))) {
+        this->lightOffsets.resize(pointLightFrames.size());
+    }
+
+    void printStats() const {
+        const auto meshletStats = lgl::Mesh::getMeshletStats();
+        if (meshletStats.numMeshlets > 0) {
+            std::cout << "Meshlets culled by frustum: "
+                      << 100.0f * meshletStats.numFrustumCulled / meshletStats.numMeshlets
+                      << "%, by backface cone: "
+                      << 100.0f * meshletStats.numBackfaceCulled / meshletStats.numMeshlets << "%\n";
+        }
+
+        const auto stats = this->getStats();
+        if (stats.numFrames > 0) {
+            std::cout << stats.numUpdates << " updates over " << stats.numFrames << " frames, "
+                      << stats.numDroppedUpdates << " dropped\n";
+            std::cout << "Game objects drawn per frame: "
+                      << static_cast<float>(this->numVisibleGameObjects) / stats.numFrames
+                      << " of " << this->objectCuller.getNumObjects() << "\n";
+            const auto vertexArrays = lgl::GlState::getStats().vertexArrays;
+            std::cout << "Vertex array binds per frame: "
+                      << static_cast<float>(vertexArrays.numCalls) / stats.numFrames << " made, "
+                      << static_cast<float>(vertexArrays.numSkippedCalls) / stats.numFrames << " skipped\n";
+        }
+
+        if (this->numQueueFrames > 0) {
+            std::cout << "Render queue per frame: " << this->queueStats.numCommands / this->numQueueFrames << " draws, "
+                      << this->queueStats.numProgramSwitches / this->numQueueFrames << " program, "
+                      << this->queueStats.numMaterialSwitches / this->numQueueFrames << " material and "
+                      << this->queueStats.numVertexArraySwitches / this->numQueueFrames << " vertex array switches\n";
+        }
+
+        const auto ringStats = this->uniformRingBuffer.getStats();
+        std::cout << "Uniform ring buffer (" << (this->uniformRingBuffer.isPersistent() ? "persistent" : "mapped per frame")
+                  << "): " << ringStats.numStalls << " stalls over " << ringStats.numFrames << " frames, "
+                  << 100.0f * this->uniformRingBuffer.getUtilization() << "% of a frame used at most, "
+                  << ringStats.numGrowths << " times grown, "
+                  << ringStats.numFenceTimeouts << " fence timeouts\n";
+    }
+
+private:
+    bool isRunning() override {
+        return !glfwWindowShouldClose(this->window);
+    }
+
+    void update(Duration timestep) override {
+        cam->onUpdate(timestep);
+    }
+
+    void render(float alpha) override {
+        this->uniformRingBuffer.beginFrame();
+
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        cam->setRenderInterpolation(alpha);
+        const auto view_projection_matrix = cam->getProjectionMatrix() * cam->getViewMatrix();
+
+        // Draw nanosuits
+        const auto program = drawPath == DrawPath::RenderQueue ? this->queueShaderProgram :
+                             drawPath == DrawPath::MultiDraw ? this->multiDrawShaderProgram : this->shaderProgram;
+        program->use();
+        program->setUniform("camPosition", cam->getRenderFrame().getPosition());
+        program->setUniform("view_projection", view_projection_matrix);
+
+        const auto &visibleGameObjects = this->objectCuller.cull(*cam);
+        this->numVisibleGameObjects += visibleGameObjects.size();
+        if (drawPath == DrawPath::RenderQueue) {
+            // Each game object selects its levels of detail and records its
+            // meshes on whichever thread picks it up
+            this->renderQueue.record(visibleGameObjects.size(), 4, [&](lgl::CommandList &commandList,
+                                                                       std::size_t begin, std::size_t end){
+                for (auto i = begin; i < end; ++i) {
+                    visibleGameObjects[i]->submit(commandList, this->queueShaderProgram, *cam);
+                }
+            });
+            this->renderQueue.execute(this->uniformRingBuffer);
+
+            const auto frameStats = this->renderQueue.getStats();
+            this->queueStats.numCommands += frameStats.numCommands;
+            this->queueStats.numProgramSwitches += frameStats.numProgramSwitches;
+            this->queueStats.numMaterialSwitches += frameStats.numMaterialSwitches;
+            this->queueStats.numVertexArraySwitches += frameStats.numVertexArraySwitches;
+            ++this->numQueueFrames;
+        } else if (drawPath == DrawPath::MultiDraw) {
+            for (auto gameObject : visibleGameObjects) {
+                gameObject->submit(this->multiDrawBatch, *cam);
+            }
+            this->multiDrawBatch.render(this->multiDrawShaderProgram);
+        } else {
+            for (auto gameObject : visibleGameObjects) {
+                gameObject->render(this->shaderProgram, *cam);
+            }
+        }
+
+        // Draw lights, which share all state but their transforms
+        for (auto i = 0u; i < this->pointLightFrames.size(); ++i) {
+            const auto &f = this->pointLightFrames[i];
+            this->uniformRingBuffer.write(lgl::DrawUniformBlock(f.getModelMatrix(), f.getNormalMatrix()),
+                                          &this->lightOffsets[i]);
+        }
+        this->uniformRingBuffer.flush();
+
+        this->lightShaderProgram.use();
+        this->lightShaderProgram.setUniform("view_projection", view_projection_matrix);
+        lgl::GlState::bindVertexArray(this->lightVao);
+        for (const auto offset : this->lightOffsets) {
+            this->uniformRingBuffer.bindRange(this->lightBinding, offset, sizeof(lgl::DrawUniformBlock));
+            glDrawArrays(GL_TRIANGLES, 0, this->numLightVertices);
+        }
+        this->uniformRingBuffer.endFrame();
+
+        glfwSwapBuffers(this->window);
+        lgl::GlDeletionQueue::flush();
+        glfwPollEvents();
+    }
+
+    GLFWwindow *window;
+    lgl::ObjectCuller &objectCuller;
+    lgl::ShaderProgram *shaderProgram;
+    lgl::ShaderProgram *queueShaderProgram;
+    lgl::ShaderProgram *multiDrawShaderProgram;
+    lgl::ShaderProgram &lightShaderProgram;
+    unsigned int lightVao;
+    std::size_t numLightVertices;
+    const std::vector<lgl::Frame> &pointLightFrames;
+
+    lgl::RenderQueue renderQueue;
+    lgl::MultiDrawBatch multiDrawBatch;
+
+    // Per draw uniforms of the render queue and the lights
+    lgl::UniformRingBuffer uniformRingBuffer;
+    unsigned int lightBinding;
+    std::vector<std::size_t> lightOffsets;
+
+    lgl::RenderQueue::Stats queueStats;
+    unsigned long numQueueFrames = 0;
+    unsigned long numVisibleGameObjects = 0;
+};
+
 int main(int argc, char *argv[]) {
     // Initialize OpenGL context
     glfwInit();
@@ -60,15 +232,38 @@ int main(int argc, char *argv[]) {
 
     // Initialize OpenGL settings
     glViewport(0, 0, windowWidth, windowHeight);
-    glEnable(GL_DEPTH_TEST);
+    lgl::GlState::setEnabled(GL_DEPTH_TEST, true);
+
+    // Delete GL objects between frames rather than whenever they are destroyed
+    lgl::GlDeletionQueue::setEnabled(true);
 
     {
         // Create shaders
-        lgl::ShaderProgram shaderProgram("default.vert", "default.frag");
-        lgl::ShaderProgram lightShaderProgram("default.vert", "light.frag");
+        lgl::ShaderVariantCache shaderVariants("default.vert", "default.frag");
+        lgl::ShaderProgram lightShaderProgram("default.vert", "light.frag", {{"DRAW_UNIFORM_BLOCK", ""}});
+
+        lgl::GeometryPool geometryPool(lgl::VertexFormat::Compact);
+        lgl::ModelSettings modelSettings;
+        modelSettings.lods.maxNumLods = 4;
+        modelSettings.meshlets.maxTriangles = 124;
+
+        // A row of nanosuits, of which only those in view are drawn
+        const auto numGameObjects = argc > 1 ? std::stoul(argv[1]) : 3ul;
+        std::vector<std::unique_ptr<lgl::GameObject>> gameObjects;
+        lgl::ObjectCuller objectCuller;
+        for (auto i = 0ul; i < numGameObjects; ++i) {
+            gameObjects.push_back(std::make_unique<lgl::GameObject>("../models/nanosuit/nanosuit.obj",
+                                                                    &geometryPool, modelSettings));
+            gameObjects.back()->setScale(glm::vec3(0.2f));
+            gameObjects.back()->setPosition({4.0f * i, 0.0f, 0.0f});
+            objectCuller.add(gameObjects.back().get());
+        }
 
-        lgl::GameObject gameObject("../models/nanosuit/nanosuit.obj");
-        gameObject.setScale(glm::vec3(0.2f));
+        const auto optimizationStats = gameObjects.front()->getMeshOptimizationStats();
+        std::cout << "Vertex cache ACMR: " << optimizationStats.before.getACMR()
+                  << " -> " << optimizationStats.after.getACMR()
+                  << ", ATVR: " << optimizationStats.before.getATVR()
+                  << " -> " << optimizationStats.after.getATVR() << "\n";
 
         // Setup light
         std::vector<float> vertices {
@@ -120,7 +315,7 @@ int main(int argc, char *argv[]) {
 
         unsigned int lightVao;
         glGenVertexArrays(1, &lightVao);
-        glBindVertexArray(lightVao);
+        lgl::GlState::bindVertexArray(lightVao);
 
         unsigned int vbo;
         glGenBuffers(1, &vbo);
@@ -150,60 +345,73 @@ int main(int argc, char *argv[]) {
         cam->rotate(glm::radians(90.0f), {0.0f, 1.0f, 0.0f});
         cam->rotateInLocalFrame(glm::radians(-90.0f), {1.0f, 0.0f, 0.0f});
 
-        shaderProgram.use();
-        shaderProgram.setUniform("material.shine", 32.0f);
-
-        shaderProgram.setUniform("directionalLight.direction", {-0.2f, -1.0f, -0.3f});
-        shaderProgram.setUniform("directionalLight.lighting.ambient", glm::vec3(0.2f));
-        shaderProgram.setUniform("directionalLight.lighting.diffuse", glm::vec3(0.5f));
-        shaderProgram.setUniform("directionalLight.lighting.specular", glm::vec3(1.0f));
-
-        for (auto i = 0u; i < pointLightFrames.size(); ++i) {
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].position", pointLightFrames[i].getPosition());
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].constant", 1.0f);
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].linear", 0.09f);
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].quadratic", 0.032f);
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].lighting.ambient", glm::vec3(0.05f));
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].lighting.diffuse", glm::vec3(0.4f));
-            shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].lighting.specular", glm::vec3(0.5f));
+        // Compile the lighting shader specialized for this scene's lights
+        lgl::ShaderDefines defines{
+            {"COMPACT_VERTICES", ""},
+            {"DIRECTIONAL_LIGHT", ""},
+            {"NUM_POINT_LIGHTS", std::to_string(pointLightFrames.size())}
+        };
+        auto shaderProgram = shaderVariants.getVariant(defines);
+        auto queueDefines = defines;
+        queueDefines.emplace("DRAW_UNIFORM_BLOCK", "");
+        auto queueShaderProgram = shaderVariants.getVariant(queueDefines);
+        defines.emplace("MULTI_DRAW", "");
+        auto multiDrawShaderProgram = shaderVariants.getVariant(defines);
+
+        // The render queue's program takes each mesh's shine from the ring buffer
+        for (auto program : {shaderProgram, multiDrawShaderProgram}) {
+            program->use();
+            program->setUniform("material.shine", lgl::DEFAULT_SHINE);
         }
 
-        auto lastUpdateTime = Clock::now();
-        while (!glfwWindowShouldClose(window)) {
-            auto currentUpdateTime = Clock::now();
-            auto updateDuration = currentUpdateTime - lastUpdateTime;
-            lastUpdateTime = currentUpdateTime;
-
-            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            cam->onUpdate(updateDuration);
-            const auto view_projection_matrix = cam->getProjectionMatrix() * cam->getViewMatrix();
-
-            // Draw cubes
-            shaderProgram.use();
-            auto camPosition = cam->getPosition();
-            shaderProgram.setUniform("camPosition", camPosition);
-            shaderProgram.setUniform("view_projection", view_projection_matrix);
-
-            gameObject.render(&shaderProgram);
-
-            // Draw lights
-            for (const auto &f : pointLightFrames) {
-                lightShaderProgram.use();
-                lightShaderProgram.setUniform("view_projection", view_projection_matrix);
-                lightShaderProgram.setUniform("model", f.getModelMatrix());
-                glBindVertexArray(lightVao);
-                glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+        for (auto program : {shaderProgram, queueShaderProgram, multiDrawShaderProgram}) {
+            program->use();
+
+            program->setUniform("directionalLight.direction", {-0.2f, -1.0f, -0.3f});
+            program->setUniform("directionalLight.lighting.ambient", glm::vec3(0.2f));
+            program->setUniform("directionalLight.lighting.diffuse", glm::vec3(0.5f));
+            program->setUniform("directionalLight.lighting.specular", glm::vec3(1.0f));
+
+            for (auto i = 0u; i < pointLightFrames.size(); ++i) {
+                program->setUniform("pointLights[" + std::to_string(i) + "].position", pointLightFrames[i].getPosition());
+                program->setUniform("pointLights[" + std::to_string(i) + "].constant", 1.0f);
+                program->setUniform("pointLights[" + std::to_string(i) + "].linear", 0.09f);
+                program->setUniform("pointLights[" + std::to_string(i) + "].quadratic", 0.032f);
+                program->setUniform("pointLights[" + std::to_string(i) + "].lighting.ambient", glm::vec3(0.05f));
+                program->setUniform("pointLights[" + std::to_string(i) + "].lighting.diffuse", glm::vec3(0.4f));
+                program->setUniform("pointLights[" + std::to_string(i) + "].lighting.specular", glm::vec3(0.5f));
             }
-
-            glfwSwapBuffers(window);
-            glfwPollEvents();
         }
 
+        std::cout << "Multi draw indirect: "
+                  << (lgl::MultiDrawBatch::isIndirectSupported() ? "supported" : "not supported, drawing per mesh")
+                  << "\n";
+
+        NanosuitScene application(window, objectCuller, shaderProgram, queueShaderProgram, multiDrawShaderProgram,
+                                  lightShaderProgram, lightVao, vertices.size() / 3, pointLightFrames);
+        // Count only the state changes of the frames
+        lgl::GlState::resetStats();
+        application.run();
+        application.printStats();
+
+        const auto glStats = lgl::GlState::getStats();
+        const auto printCounts = [](const char *kind, const lgl::GlState::Counts &counts){
+            std::cout << "  " << kind << ": " << counts.numCalls << " made, "
+                      << counts.numSkippedCalls << " skipped\n";
+        };
+        const auto totalCounts = glStats.getTotal();
+        std::cout << "State changes: " << totalCounts.numCalls << " made, "
+                  << totalCounts.numSkippedCalls << " skipped as redundant\n";
+        printCounts("Programs", glStats.programs);
+        printCounts("Vertex array binds", glStats.vertexArrays);
+        printCounts("Active texture units", glStats.textureUnits);
+        printCounts("Texture binds", glStats.textures);
+        printCounts("Capabilities", glStats.capabilities);
+
         cam.reset();
     }
 
+    lgl::GlDeletionQueue::flush();
     glfwTerminate();
     return EXIT_SUCCESS;
 }
@@ -222,6 +430,10 @@ void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods
     if (action == GLFW_PRESS) {
         switch (key) {
         case GLFW_KEY_ESCAPE: glfwSetWindowShouldClose(window, true); break;
+        case GLFW_KEY_Q:
+            drawPath = drawPath == DrawPath::RenderQueue ? DrawPath::MultiDraw :
+                       drawPath == DrawPath::MultiDraw ? DrawPath::Meshlets : DrawPath::RenderQueue;
+            break;
         case FORWARD_KEY: cam->setLocalSpeedX(speed); break;
         case BACK_KEY: cam->setLocalSpeedX(-speed); break;
         case LEFT_KEY: cam->setLocalSpeedY(speed); break;
@@ -0,0 +1,59 @@
+#version 330 core
+
+// Set by the application:
+//   DIRECTIONAL_LIGHT - enables the directional light
+//   NUM_POINT_LIGHTS  - number of point lights, compiled out when 0
+#ifndef NUM_POINT_LIGHTS
+#define NUM_POINT_LIGHTS 0
+#endif
+
+#include "../shaders/lighting.glsl"
+
+in vec3 fragNormal;
+in vec3 fragPosition;
+in vec2 texCoords;
+
+out vec4 fragColor;
+
+struct Material {
+    sampler2D diffuseTexture0;
+    sampler2D specularTexture0;
+    float shine;
+};
+
+uniform Material material;
+#ifdef DIRECTIONAL_LIGHT
+uniform DirectionalLight directionalLight;
+#endif
+#if NUM_POINT_LIGHTS > 0
+uniform PointLight pointLights[NUM_POINT_LIGHTS];
+#endif
+uniform vec3 camPosition;
+
+void main() {
+    vec3 normal = normalize(fragNormal);
+    vec3 camDirection = normalize(camPosition - fragPosition);
+    vec3 diffuseColor = vec3(texture(material.diffuseTexture0, texCoords));
+    vec3 specularColor = vec3(texture(material.specularTexture0, texCoords));
+
+    vec3 lighting = vec3(0.0);
+
+#ifdef DIRECTIONAL_LIGHT
+    lighting += calculateBaseLight(normalize(directionalLight.direction),
+                                   directionalLight.lighting,
+                                   normal, camDirection,
+                                   diffuseColor, specularColor, material.shine);
+#endif
+
+#if NUM_POINT_LIGHTS > 0
+    for (int i = 0; i < NUM_POINT_LIGHTS; ++i) {
+        vec3 lightDirection = normalize(fragPosition - pointLights[i].position);
+        lighting += calculateBaseLight(lightDirection, pointLights[i].lighting,
+                                       normal, camDirection,
+                                       diffuseColor, specularColor, material.shine) *
+                calculateAttenuation(pointLights[i], fragPosition);
+    }
+#endif
+
+    fragColor = vec4(lighting, 1.0);
+}
@@ -0,0 +1,17 @@
+#version 330 core
+
+#include "../shaders/vertex_input.glsl"
+
+out vec3 fragNormal;
+out vec3 fragPosition;
+out vec2 texCoords;
+
+uniform mat4 view_projection;
+
+void main() {
+    vec4 position = getModelMatrix() * vec4(getPosition(), 1.0);
+    gl_Position = view_projection * position;
+    fragNormal = getNormalMatrix() * aNormal;
+    fragPosition = vec3(position);
+    texCoords = aTexCoords;
+}
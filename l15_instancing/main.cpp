@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/glm.hpp>
+
+#include <lgl/Aabb.h>
+#include <lgl/Application.h>
+#include <lgl/Archetype.h>
+#include <lgl/Camera.h>
+#include <lgl/Components.h>
+#include <lgl/Frustum.h>
+#include <lgl/GameObject.h>
+#include <lgl/GlHandle.h>
+#include <lgl/GlState.h>
+#include <lgl/OcclusionCuller.h>
+#include <lgl/ShaderProgram.h>
+#include <lgl/ShaderVariantCache.h>
+#include <lgl/TransformBatch.h>
+
+using Clock = std::chrono::steady_clock;
+
+using RockStore = lgl::Archetype<lgl::TransformComponent, lgl::VelocityComponent,
+                                 lgl::BoundsComponent, lgl::RenderComponent>;
+
+std::unique_ptr<lgl::Camera> cam;
+
+// Toggled with O
+auto isOcclusionCullingEnabled = true;
+
+static void frameBufferSizeCallback(GLFWwindow *window, int width, int height);
+static void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
+static void cursorPosCallback(GLFWwindow *window, double x, double y);
+static void scrollCallback(GLFWwindow *window, double xOffset, double yOffset);
+
+// Simulates the scene in fixed steps and renders it interpolated between them.
+// Rocks are entities of an Archetype that the component systems spin, bound,
+// frustum cull and batch. Rocks hidden behind the planet are culled on the CPU
+// before they are drawn.
+class AsteroidBelt : public lgl::Application {
+public:
+    AsteroidBelt(GLFWwindow *window, lgl::GameObject &planet, lgl::GameObject &rock, RockStore &rocks,
+                 lgl::ShaderProgram *shaderProgram, lgl::ShaderProgram *instancedShaderProgram) :
+        window(window), planet(planet), rock(rock), rocks(rocks),
+        shaderProgram(shaderProgram), instancedShaderProgram(instancedShaderProgram),
+        lastReportTime(Clock::now()) {
+        lgl::updateWorldBounds(this->rocks);
+    }
+
+private:
+    bool isRunning() override {
+        return !glfwWindowShouldClose(this->window);
+    }
+
+    void update(Duration timestep) override {
+        static const auto planetSpeed = glm::radians(10.0f);
+
+        cam->onUpdate(timestep);
+        this->planet.onUpdate(timestep);
+        this->planet.rotate(planetSpeed * timestep.count(), {0.0f, 1.0f, 0.0f});
+
+        lgl::integrateVelocities(this->rocks, timestep.count());
+        lgl::updateWorldBounds(this->rocks);
+    }
+
+    void render(float alpha) override {
+        glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        cam->setRenderInterpolation(alpha);
+        this->planet.setRenderInterpolation(alpha);
+        const auto view_projection_matrix = cam->getProjectionMatrix() * cam->getViewMatrix();
+        const auto camPosition = cam->getRenderFrame().getPosition();
+
+        this->shaderProgram->use();
+        this->shaderProgram->setUniform("camPosition", camPosition);
+        this->shaderProgram->setUniform("view_projection", view_projection_matrix);
+        this->planet.render(this->shaderProgram);
+
+        // One draw call for all rocks, as of the last update since they spin slowly
+        this->cullRocks(view_projection_matrix);
+        lgl::buildInstances(this->rocks, this->visibleIndices, &this->rock, this->visibleRocks);
+        this->instancedShaderProgram->use();
+        this->instancedShaderProgram->setUniform("camPosition", camPosition);
+        this->instancedShaderProgram->setUniform("view_projection", view_projection_matrix);
+        this->rock.renderInstanced(this->instancedShaderProgram, this->visibleRocks);
+
+        glfwSwapBuffers(this->window);
+        lgl::GlDeletionQueue::flush();
+        glfwPollEvents();
+
+        ++this->numFrames;
+        const auto currentTime = Clock::now();
+        if (currentTime - this->lastReportTime > std::chrono::seconds(1)) {
+            const std::chrono::duration<float, std::milli> reportDuration = currentTime - this->lastReportTime;
+            std::cout << this->rocks.getSize() << " rocks, " << this->visibleRocks.getSize() << " drawn: "
+                      << reportDuration.count() / this->numFrames << " ms per frame";
+            if (isOcclusionCullingEnabled) {
+                const auto stats = this->occlusionCuller.getStats();
+                std::cout << ", " << stats.numOccluderTriangles << " occluder triangles, "
+                          << stats.numOccluded << " of " << stats.numTested << " rocks culled";
+            }
+            std::cout << "\n";
+            this->lastReportTime = currentTime;
+            this->numFrames = 0;
+        }
+    }
+
+    // Indices of rocks that are in view and, if enabled, not hidden by the planet
+    void cullRocks(const glm::mat4 &viewProjectionMatrix) {
+        lgl::collectVisible(this->rocks, lgl::Frustum(viewProjectionMatrix), this->visibleIndices);
+        if (!isOcclusionCullingEnabled) {
+            return;
+        }
+
+        this->occlusionCuller.beginFrame(viewProjectionMatrix);
+        this->planet.rasterizeOccluder(this->occlusionCuller);
+        this->occlusionCuller.rasterize();
+
+        const auto &bounds = this->rocks.getArray<lgl::BoundsComponent>();
+        this->visibleIndices.erase(std::remove_if(this->visibleIndices.begin(), this->visibleIndices.end(),
+                                                  [this, &bounds](unsigned int i){
+            return !this->occlusionCuller.isVisible(bounds[i].world);
+        }), this->visibleIndices.end());
+    }
+
+    GLFWwindow *window;
+    lgl::GameObject &planet;
+    lgl::GameObject &rock;
+    RockStore &rocks;
+    std::vector<unsigned int> visibleIndices;
+    lgl::TransformBatch visibleRocks;
+    lgl::OcclusionCuller occlusionCuller;
+    lgl::ShaderProgram *shaderProgram;
+    lgl::ShaderProgram *instancedShaderProgram;
+    Clock::time_point lastReportTime;
+    unsigned int numFrames = 0;
+};
+
+int main(int argc, char *argv[]) {
+    // Initialize OpenGL context
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    const int windowWidth = 800;
+    const int windowHeight = 600;
+    auto window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGL", nullptr, nullptr);
+    if (window == nullptr) {
+        std::cerr << "Failed to create GLFW window\n";
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
+        std::cerr << "Failed to initialize GLAD\n";
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+
+    // Set window callbacks
+    glfwSetFramebufferSizeCallback(window, frameBufferSizeCallback);
+
+    glfwSetKeyCallback(window, keyCallback);
+
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwSetCursorPosCallback(window, cursorPosCallback);
+
+    glfwSetScrollCallback(window, scrollCallback);
+
+    // Initialize OpenGL settings
+    glViewport(0, 0, windowWidth, windowHeight);
+    lgl::GlState::setEnabled(GL_DEPTH_TEST, true);
+
+    // Delete GL objects between frames rather than whenever they are destroyed
+    lgl::GlDeletionQueue::setEnabled(true);
+
+    {
+        lgl::ShaderVariantCache shaderVariants("default.vert", "default.frag");
+
+        lgl::ModelSettings planetSettings;
+        planetSettings.isOccluder = true;
+        lgl::GameObject planet("../models/planet/planet.obj", lgl::VertexFormat::Float, planetSettings);
+        planet.setScale(glm::vec3(4.0f));
+        planet.setPosition({0.0f, -3.0f, 0.0f});
+
+        lgl::GameObject rock("../models/rock/rock.obj");
+
+        // Asteroid belt of randomly displaced, scaled, rotated and spinning rocks
+        const auto numRocks = argc > 1 ? std::stoul(argv[1]) : 100000ul;
+        const auto radius = 150.0f;
+        const auto displacement = 25.0f;
+        std::mt19937 generator(0);
+        std::uniform_real_distribution<float> offset(-displacement, displacement);
+        std::uniform_real_distribution<float> scale(0.05f, 0.25f);
+        std::uniform_real_distribution<float> angle(0.0f, glm::two_pi<float>());
+        std::uniform_real_distribution<float> spin(-0.5f, 0.5f);
+
+        // The rock model is at the origin, so its world bounds are local to each rock
+        lgl::BoundsComponent rockBounds;
+        rockBounds.local = rock.getWorldBounds();
+
+        RockStore rocks;
+        for (auto i = 0ul; i < numRocks; ++i) {
+            const auto a = glm::two_pi<float>() * i / numRocks;
+            lgl::TransformComponent transform;
+            transform.position = {std::sin(a) * radius + offset(generator),
+                                  0.4f * offset(generator) - 3.0f,
+                                  std::cos(a) * radius + offset(generator)};
+            transform.scale = glm::vec3(scale(generator));
+            transform.orientation = glm::angleAxis(angle(generator), glm::normalize(glm::vec3(0.4f, 0.6f, 0.8f)));
+
+            lgl::VelocityComponent velocity;
+            velocity.angular = {spin(generator), spin(generator), spin(generator)};
+            rocks.create(transform, velocity, rockBounds, lgl::RenderComponent{&rock});
+        }
+
+        // Setup camera
+        cam = std::make_unique<lgl::Camera>(glm::radians(45.0f), static_cast<float>(windowWidth) / windowHeight, 0.1f, 1000.0f);
+        cam->setPosition({0.0f, 0.0f, 200.0f});
+        cam->rotate(glm::radians(90.0f), {0.0f, 1.0f, 0.0f});
+        cam->rotateInLocalFrame(glm::radians(-90.0f), {1.0f, 0.0f, 0.0f});
+
+        auto shaderProgram = shaderVariants.getVariant({{"DIRECTIONAL_LIGHT", ""}});
+        auto instancedShaderProgram = shaderVariants.getVariant({{"DIRECTIONAL_LIGHT", ""}, {"INSTANCED", ""}});
+        for (auto program : {shaderProgram, instancedShaderProgram}) {
+            program->use();
+            program->setUniform("material.shine", 32.0f);
+            program->setUniform("directionalLight.direction", {-0.2f, -1.0f, -0.3f});
+            program->setUniform("directionalLight.lighting.ambient", glm::vec3(0.2f));
+            program->setUniform("directionalLight.lighting.diffuse", glm::vec3(0.7f));
+            program->setUniform("directionalLight.lighting.specular", glm::vec3(0.2f));
+        }
+
+        AsteroidBelt application(window, planet, rock, rocks, shaderProgram, instancedShaderProgram);
+        application.run();
+
+        const auto stats = application.getStats();
+        std::cout << stats.numUpdates << " updates over " << stats.numFrames << " frames, "
+                  << stats.numDroppedUpdates << " dropped\n";
+
+        cam.reset();
+    }
+
+    lgl::GlDeletionQueue::flush();
+    glfwTerminate();
+    return EXIT_SUCCESS;
+}
+
+void frameBufferSizeCallback(GLFWwindow *window, int width, int height) {
+    glViewport(0, 0, width, height);
+}
+
+void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods) {
+    static const auto FORWARD_KEY = GLFW_KEY_W;
+    static const auto BACK_KEY = GLFW_KEY_S;
+    static const auto LEFT_KEY = GLFW_KEY_A;
+    static const auto RIGHT_KEY = GLFW_KEY_D;
+    static const auto speed = 10.0f;
+
+    if (action == GLFW_PRESS) {
+        switch (key) {
+        case GLFW_KEY_ESCAPE: glfwSetWindowShouldClose(window, true); break;
+        case GLFW_KEY_O: isOcclusionCullingEnabled = !isOcclusionCullingEnabled; break;
+        case FORWARD_KEY: cam->setLocalSpeedX(speed); break;
+        case BACK_KEY: cam->setLocalSpeedX(-speed); break;
+        case LEFT_KEY: cam->setLocalSpeedY(speed); break;
+        case RIGHT_KEY: cam->setLocalSpeedY(-speed); break;
+        default: break;
+        }
+    } else if (action == GLFW_RELEASE) {
+        switch (key) {
+        case FORWARD_KEY:
+            switch (glfwGetKey(window, BACK_KEY)) {
+            case GLFW_PRESS: cam->setLocalSpeedX(-speed); break;
+            case GLFW_RELEASE: cam->setLocalSpeedX(0.0f); break;
+            default: break;
+            }
+            break;
+
+        case BACK_KEY:
+            switch (glfwGetKey(window, FORWARD_KEY)) {
+            case GLFW_PRESS: cam->setLocalSpeedX(speed); break;
+            case GLFW_RELEASE: cam->setLocalSpeedX(0.0f); break;
+            default: break;
+            }
+            break;
+
+        case LEFT_KEY:
+            switch (glfwGetKey(window, RIGHT_KEY)) {
+            case GLFW_PRESS: cam->setLocalSpeedY(-speed); break;
+            case GLFW_RELEASE: cam->setLocalSpeedY(0.0f); break;
+            default: break;
+            }
+            break;
+
+        case RIGHT_KEY:
+            switch (glfwGetKey(window, LEFT_KEY)) {
+            case GLFW_PRESS: cam->setLocalSpeedY(speed); break;
+            case GLFW_RELEASE: cam->setLocalSpeedY(0.0f); break;
+            default: break;
+            }
+            break;
+
+        default: break;
+        }
+    }
+}
+
+void cursorPosCallback(GLFWwindow *window, double x, double y) {
+    static const auto sensitivity = 0.002f;
+    static auto lastX = x;
+    static auto lastY = y;
+
+    const auto offsetX = x - lastX;
+    const auto offsetY = y - lastY;
+    lastX = x;
+    lastY = y;
+
+    cam->rotateInLocalFrame(offsetY * sensitivity, {0.0f, 1.0f, 0.0f});
+    cam->rotate(offsetX * sensitivity, {0.0f, -1.0f, 0.0f});
+}
+
+void scrollCallback(GLFWwindow *window, double xOffset, double yOffset) {
+    static const auto minFOV_deg = 1.0f;
+    static const auto maxFOV_deg = 45.0f;
+    auto fov_deg = glm::degrees(cam->getFOV()) - static_cast<float>(yOffset);
+    fov_deg = std::max(minFOV_deg, fov_deg);
+    fov_deg = std::min(maxFOV_deg, fov_deg);
+    cam->setFOV(glm::radians(fov_deg));
+}
@@ -5,6 +5,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <lgl/GlState.h>
 #include <lgl/ShaderProgram.h>
 
 static void frameBufferSizeCallback(GLFWwindow *window, int width, int height);
@@ -54,7 +55,7 @@ int main(int argc, char *argv[]) {
 
     unsigned int vao;
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    lgl::GlState::bindVertexArray(vao);
 
     unsigned int vbo;
     glGenBuffers(1, &vbo);
@@ -79,7 +80,7 @@ int main(int argc, char *argv[]) {
         glClear(GL_COLOR_BUFFER_BIT);
 
         shaderProgram.use();
-        glBindVertexArray(vao);
+        lgl::GlState::bindVertexArray(vao);
         glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
 
         glfwSwapBuffers(window);
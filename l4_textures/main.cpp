@@ -5,6 +5,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <lgl/GlState.h>
 #include <lgl/ShaderProgram.h>
 #include <lgl/Texture2D.h>
 
@@ -57,7 +58,7 @@ int main(int argc, char *argv[]) {
 
         unsigned int vao;
         glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
+        lgl::GlState::bindVertexArray(vao);
 
         unsigned int vbo;
         glGenBuffers(1, &vbo);
@@ -100,13 +101,13 @@ int main(int argc, char *argv[]) {
 
             shaderProgram.use();
 
-            glActiveTexture(GL_TEXTURE0);
+            lgl::GlState::activeTexture(0);
             containerTexture.bind();
 
-            glActiveTexture(GL_TEXTURE1);
+            lgl::GlState::activeTexture(1);
             faceTexture.bind();
 
-            glBindVertexArray(vao);
+            lgl::GlState::bindVertexArray(vao);
             glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
 
             glfwSwapBuffers(window);
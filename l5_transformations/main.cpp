@@ -7,6 +7,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/glm.hpp>
 
+#include <lgl/GlState.h>
 #include <lgl/ShaderProgram.h>
 #include <lgl/Texture2D.h>
 
@@ -59,7 +60,7 @@ int main(int argc, char *argv[]) {
 
         unsigned int vao;
         glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
+        lgl::GlState::bindVertexArray(vao);
 
         unsigned int vbo;
         glGenBuffers(1, &vbo);
@@ -97,10 +98,10 @@ int main(int argc, char *argv[]) {
 
             shaderProgram.use();
 
-            glActiveTexture(GL_TEXTURE0);
+            lgl::GlState::activeTexture(0);
             containerTexture.bind();
 
-            glActiveTexture(GL_TEXTURE1);
+            lgl::GlState::activeTexture(1);
             faceTexture.bind();
 
             auto transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f, -0.5f, 0.0f));
@@ -108,7 +109,7 @@ int main(int argc, char *argv[]) {
             transform = glm::scale(transform, glm::vec3(0.5f));
             shaderProgram.setUniform("transform", transform);
 
-            glBindVertexArray(vao);
+            lgl::GlState::bindVertexArray(vao);
             glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
 
             glfwSwapBuffers(window);
@@ -8,6 +8,7 @@
 #include <glm/glm.hpp>
 
 #include <lgl/Camera.h>
+#include <lgl/GlState.h>
 #include <lgl/ShaderProgram.h>
 #include <lgl/Texture2D.h>
 
@@ -41,7 +42,7 @@ int main(int argc, char *argv[]) {
     glViewport(0, 0, windowWidth, windowHeight);
     glfwSetFramebufferSizeCallback(window, frameBufferSizeCallback);
 
-    glEnable(GL_DEPTH_TEST);
+    lgl::GlState::setEnabled(GL_DEPTH_TEST, true);
 
     {
         lgl::ShaderProgram shaderProgram("default.vert", "default.frag");
@@ -93,7 +94,7 @@ int main(int argc, char *argv[]) {
 
         unsigned int vao;
         glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
+        lgl::GlState::bindVertexArray(vao);
 
         unsigned int vbo;
         glGenBuffers(1, &vbo);
@@ -148,10 +149,10 @@ int main(int argc, char *argv[]) {
             shaderProgram.use();
             shaderProgram.setUniform("view_projection", cam.getProjectionMatrix() * cam.getViewMatrix());
 
-            glActiveTexture(GL_TEXTURE0);
+            lgl::GlState::activeTexture(0);
             containerTexture.bind();
 
-            glActiveTexture(GL_TEXTURE1);
+            lgl::GlState::activeTexture(1);
             faceTexture.bind();
 
             auto i = 0;
@@ -159,7 +160,7 @@ int main(int argc, char *argv[]) {
                 f.rotate(glm::radians(static_cast<float>(++i)), {0.5f, 1.0f, 0.0f});
                 shaderProgram.setUniform("model", f.getModelMatrix());
 
-                glBindVertexArray(vao);
+                lgl::GlState::bindVertexArray(vao);
                 glDrawArrays(GL_TRIANGLES, 0, vertices.size());
             }
 
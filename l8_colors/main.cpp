@@ -10,6 +10,7 @@
 #include <glm/glm.hpp>
 
 #include <lgl/Camera.h>
+#include <lgl/GlState.h>
 #include <lgl/ShaderProgram.h>
 #include <lgl/Texture2D.h>
 
@@ -58,7 +59,7 @@ int main(int argc, char *argv[]) {
 
     // Initialize OpenGL settings
     glViewport(0, 0, windowWidth, windowHeight);
-    glEnable(GL_DEPTH_TEST);
+    lgl::GlState::setEnabled(GL_DEPTH_TEST, true);
 
     {
         // Create shaders
@@ -112,7 +113,7 @@ int main(int argc, char *argv[]) {
 
         unsigned int vao;
         glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
+        lgl::GlState::bindVertexArray(vao);
 
         unsigned int vbo;
         glGenBuffers(1, &vbo);
@@ -130,7 +131,7 @@ int main(int argc, char *argv[]) {
         // Setup light
         unsigned int lightVao;
         glGenVertexArrays(1, &lightVao);
-        glBindVertexArray(lightVao);
+        lgl::GlState::bindVertexArray(lightVao);
 
         glBindBuffer(GL_ARRAY_BUFFER, vao); // Use conatiner vbo
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(decltype(vertices)::value_type),
@@ -167,14 +168,14 @@ int main(int argc, char *argv[]) {
             shaderProgram.use();
             shaderProgram.setUniform("view_projection", view_projection_matrix);
             shaderProgram.setUniform("model", frame.getModelMatrix());
-            glBindVertexArray(vao);
+            lgl::GlState::bindVertexArray(vao);
             glDrawArrays(GL_TRIANGLES, 0, vertices.size());
 
             // Draw light
             lightShader.use();
             lightShader.setUniform("view_projection", view_projection_matrix);
             lightShader.setUniform("model", lightFrame.getModelMatrix());
-            glBindVertexArray(lightVao);
+            lgl::GlState::bindVertexArray(lightVao);
             glDrawArrays(GL_TRIANGLES, 0, vertices.size());
 
             glfwSwapBuffers(window);
@@ -0,0 +1,9 @@
+#version 330 core
+
+#include "vertex_input.glsl"
+
+uniform mat4 view_projection;
+
+void main() {
+    gl_Position = view_projection * getModelMatrix() * vec4(getPosition(), 1.0);
+}
@@ -0,0 +1,10 @@
+// Per draw data bound from an lgl::UniformRingBuffer, see
+// lgl::DrawUniformBlock. Stages of a program that both read it must declare
+// it alike, so they include this file.
+layout (std140) uniform DrawUniforms {
+    mat4 model;
+    mat3 normal;
+    vec3 positionScale;
+    float shine;
+    vec3 positionOffset;
+};
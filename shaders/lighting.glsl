@@ -0,0 +1,42 @@
+struct Lighting {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct DirectionalLight {
+    vec3 direction;
+    Lighting lighting;
+};
+
+struct PointLight {
+    vec3 position;
+
+    float constant;
+    float linear;
+    float quadratic;
+
+    Lighting lighting;
+};
+
+vec3 calculateBaseLight(vec3 lightDirection, Lighting lighting,
+                        vec3 normal, vec3 camDirection,
+                        vec3 diffuseColor, vec3 specularColor, float shine) {
+    // Diffuse lighting
+    float diffuse = max(dot(normal, -lightDirection), 0.0);
+
+    // Specular lighting
+    vec3 reflectDirection = reflect(lightDirection, normal);
+    float specular = pow(max(dot(camDirection, reflectDirection), 0.0), shine);
+
+    return diffuseColor * lighting.ambient +
+        diffuse * diffuseColor * lighting.diffuse +
+        specular * specularColor * lighting.specular;
+}
+
+float calculateAttenuation(PointLight light, vec3 position) {
+    float distance = length(light.position - position);
+    return 1.0 / (light.constant +
+                  light.linear * distance +
+                  light.quadratic * distance * distance);
+}
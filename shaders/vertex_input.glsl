@@ -0,0 +1,76 @@
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+#ifdef DRAW_UNIFORM_BLOCK
+// Includes resolve from the directory of the shader being compiled
+#include "../shaders/draw_uniforms.glsl"
+#endif
+
+#ifdef MULTI_DRAW
+// Per draw data of lgl::MultiDrawBatch, nine texels a draw: model matrix
+// columns, normal matrix columns, position scale and position offset. Each
+// draw's base instance offsets the draw id.
+layout (location = 10) in uint aDrawId;
+uniform samplerBuffer drawData;
+
+vec4 getDrawData(int texel) {
+    return texelFetch(drawData, int(aDrawId) * 9 + texel);
+}
+#elif defined(COMPACT_VERTICES) && !defined(DRAW_UNIFORM_BLOCK)
+// Compact positions arrive normalized to [0, 1] within the mesh bounds
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+#endif
+
+vec3 getPosition() {
+#if defined(COMPACT_VERTICES) && defined(MULTI_DRAW)
+    return aPos * getDrawData(7).xyz + getDrawData(8).xyz;
+#elif defined(COMPACT_VERTICES)
+    return aPos * positionScale + positionOffset;
+#else
+    return aPos;
+#endif
+}
+
+#ifdef INSTANCED
+// Per instance transforms, see lgl::InstanceTransform. Matrices take one
+// location per column.
+layout (location = 3) in mat4 aInstanceModel;
+layout (location = 7) in mat3 aInstanceNormal;
+
+mat4 getModelMatrix() {
+    return aInstanceModel;
+}
+
+mat3 getNormalMatrix() {
+    return aInstanceNormal;
+}
+#elif defined(MULTI_DRAW)
+mat4 getModelMatrix() {
+    return mat4(getDrawData(0), getDrawData(1), getDrawData(2), getDrawData(3));
+}
+
+mat3 getNormalMatrix() {
+    return mat3(getDrawData(4).xyz, getDrawData(5).xyz, getDrawData(6).xyz);
+}
+#elif defined(DRAW_UNIFORM_BLOCK)
+mat4 getModelMatrix() {
+    return model;
+}
+
+mat3 getNormalMatrix() {
+    return normal;
+}
+#else
+uniform mat4 model;
+uniform mat3 normal;
+
+mat4 getModelMatrix() {
+    return model;
+}
+
+mat3 getNormalMatrix() {
+    return normal;
+}
+#endif
@@ -0,0 +1,52 @@
+#include <lgl/Aabb.h>
+
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
+
+namespace lgl {
+
+bool isEmpty(const Aabb &box) {
+    return glm::any(glm::greaterThan(box.min, box.max));
+}
+
+bool contains(const Aabb &outer, const Aabb &inner) {
+    return glm::all(glm::lessThanEqual(outer.min, inner.min)) &&
+           glm::all(glm::greaterThanEqual(outer.max, inner.max));
+}
+
+Aabb merge(const Aabb &a, const Aabb &b) {
+    return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+}
+
+Aabb merge(const Aabb &box, const glm::vec3 &point) {
+    return {glm::min(box.min, point), glm::max(box.max, point)};
+}
+
+Aabb inflate(const Aabb &box, float margin) {
+    return {box.min - margin, box.max + margin};
+}
+
+float getSurfaceArea(const Aabb &box) {
+    if (isEmpty(box)) {
+        return 0.0f;
+    }
+    const auto size = box.max - box.min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+Aabb transform(const Aabb &box, const glm::mat4 &matrix) {
+    if (isEmpty(box)) {
+        return box;
+    }
+
+    const auto center = 0.5f * (box.min + box.max);
+    const auto extent = 0.5f * (box.max - box.min);
+    const auto newCenter = glm::vec3(matrix * glm::vec4(center, 1.0f));
+    glm::vec3 newExtent(0.0f);
+    for (auto column = 0; column < 3; ++column) {
+        newExtent += glm::abs(glm::vec3(matrix[column])) * extent[column];
+    }
+    return {newCenter - newExtent, newCenter + newExtent};
+}
+
+} // namespace lgl
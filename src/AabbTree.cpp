@@ -0,0 +1,252 @@
+#include <lgl/AabbTree.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace lgl {
+
+constexpr AabbTree::ProxyId AabbTree::NULL_PROXY;
+
+AabbTree::AabbTree(float margin) :
+    margin(margin) {}
+
+AabbTree::ProxyId AabbTree::createProxy(const Aabb &bounds, unsigned int userData) {
+    const auto leaf = this->allocateNode();
+    auto &node = this->nodes[leaf];
+    node.bounds = inflate(bounds, this->margin);
+    node.userData = userData;
+    node.height = 0;
+    this->insertLeaf(leaf);
+    return leaf;
+}
+
+void AabbTree::destroyProxy(ProxyId proxy) {
+    assert(("Only leaves are proxies", this->isLeaf(proxy)));
+    this->removeLeaf(proxy);
+    this->freeNode(proxy);
+}
+
+bool AabbTree::moveProxy(ProxyId proxy, const Aabb &bounds) {
+    assert(("Only leaves are proxies", this->isLeaf(proxy)));
+    if (contains(this->nodes[proxy].bounds, bounds)) {
+        return false;
+    }
+
+    this->removeLeaf(proxy);
+    this->nodes[proxy].bounds = inflate(bounds, this->margin);
+    this->insertLeaf(proxy);
+    return true;
+}
+
+void AabbTree::query(const Frustum &frustum, std::vector<unsigned int> &userData, QueryStats *stats) const {
+    if (this->root == NULL_PROXY) {
+        return;
+    }
+
+    // Local so that queries may run concurrently. A depth first traversal
+    // never holds more than one node per level.
+    std::vector<ProxyId> stack;
+    stack.reserve(this->getHeight() + 1);
+    stack.push_back(this->root);
+    while (!stack.empty()) {
+        const auto node = stack.back();
+        stack.pop_back();
+
+        if (stats) {
+            ++stats->numTested;
+        }
+        const auto containment = frustum.testBox(this->nodes[node].bounds);
+        if (containment == Frustum::Containment::Outside) {
+            continue;
+        }
+        if (containment == Frustum::Containment::Inside || this->isLeaf(node)) {
+            this->appendLeaves(node, userData, stats);
+            continue;
+        }
+        stack.push_back(this->nodes[node].children[0]);
+        stack.push_back(this->nodes[node].children[1]);
+    }
+}
+
+AabbTree::ProxyId AabbTree::allocateNode() {
+    ProxyId node;
+    if (this->freeList == NULL_PROXY) {
+        node = static_cast<ProxyId>(this->nodes.size());
+        this->nodes.emplace_back();
+    } else {
+        node = this->freeList;
+        this->freeList = this->nodes[node].parent;
+    }
+
+    auto &n = this->nodes[node];
+    n.parent = NULL_PROXY;
+    n.children[0] = NULL_PROXY;
+    n.children[1] = NULL_PROXY;
+    n.height = 0;
+    return node;
+}
+
+void AabbTree::freeNode(ProxyId node) {
+    this->nodes[node].parent = this->freeList;
+    this->nodes[node].height = -1;
+    this->freeList = node;
+}
+
+void AabbTree::insertLeaf(ProxyId leaf) {
+    if (this->root == NULL_PROXY) {
+        this->root = leaf;
+        this->nodes[leaf].parent = NULL_PROXY;
+        return;
+    }
+
+    // Descend towards the sibling that grows the total surface area least
+    const auto leafBounds = this->nodes[leaf].bounds;
+    auto sibling = this->root;
+    while (!this->isLeaf(sibling)) {
+        const auto &node = this->nodes[sibling];
+        const auto area = getSurfaceArea(node.bounds);
+        const auto combinedArea = getSurfaceArea(merge(node.bounds, leafBounds));
+
+        // Cost of pairing with this node vs. pushing the leaf further down
+        const auto cost = 2.0f * combinedArea;
+        const auto inheritanceCost = 2.0f * (combinedArea - area);
+        const auto getChildCost = [this, &leafBounds, inheritanceCost](ProxyId child){
+            const auto &bounds = this->nodes[child].bounds;
+            const auto newArea = getSurfaceArea(merge(bounds, leafBounds));
+            return this->isLeaf(child) ? newArea + inheritanceCost
+                                       : newArea - getSurfaceArea(bounds) + inheritanceCost;
+        };
+        const auto cost0 = getChildCost(node.children[0]);
+        const auto cost1 = getChildCost(node.children[1]);
+
+        if (cost < cost0 && cost < cost1) {
+            break;
+        }
+        sibling = cost0 < cost1 ? node.children[0] : node.children[1];
+    }
+
+    // Replace the sibling with a new parent of both
+    const auto oldParent = this->nodes[sibling].parent;
+    const auto newParent = this->allocateNode();
+    auto &parent = this->nodes[newParent];
+    parent.parent = oldParent;
+    parent.bounds = merge(leafBounds, this->nodes[sibling].bounds);
+    parent.height = this->nodes[sibling].height + 1;
+    parent.children[0] = sibling;
+    parent.children[1] = leaf;
+    this->nodes[sibling].parent = newParent;
+    this->nodes[leaf].parent = newParent;
+
+    if (oldParent == NULL_PROXY) {
+        this->root = newParent;
+    } else {
+        auto &children = this->nodes[oldParent].children;
+        children[children[0] == sibling ? 0 : 1] = newParent;
+    }
+
+    // Refit and rebalance the ancestors
+    for (auto node = this->nodes[leaf].parent; node != NULL_PROXY; node = this->nodes[node].parent) {
+        node = this->balance(node);
+        auto &n = this->nodes[node];
+        const auto &child0 = this->nodes[n.children[0]];
+        const auto &child1 = this->nodes[n.children[1]];
+        n.height = 1 + std::max(child0.height, child1.height);
+        n.bounds = merge(child0.bounds, child1.bounds);
+    }
+}
+
+void AabbTree::removeLeaf(ProxyId leaf) {
+    if (leaf == this->root) {
+        this->root = NULL_PROXY;
+        return;
+    }
+
+    // The sibling takes the place of the parent
+    const auto parent = this->nodes[leaf].parent;
+    const auto grandParent = this->nodes[parent].parent;
+    const auto &parentChildren = this->nodes[parent].children;
+    const auto sibling = parentChildren[0] == leaf ? parentChildren[1] : parentChildren[0];
+
+    this->nodes[sibling].parent = grandParent;
+    this->freeNode(parent);
+    if (grandParent == NULL_PROXY) {
+        this->root = sibling;
+        return;
+    }
+
+    auto &children = this->nodes[grandParent].children;
+    children[children[0] == parent ? 0 : 1] = sibling;
+    for (auto node = grandParent; node != NULL_PROXY; node = this->nodes[node].parent) {
+        node = this->balance(node);
+        auto &n = this->nodes[node];
+        const auto &child0 = this->nodes[n.children[0]];
+        const auto &child1 = this->nodes[n.children[1]];
+        n.height = 1 + std::max(child0.height, child1.height);
+        n.bounds = merge(child0.bounds, child1.bounds);
+    }
+}
+
+AabbTree::ProxyId AabbTree::balance(ProxyId node) {
+    if (this->isLeaf(node) || this->nodes[node].height < 2) {
+        return node;
+    }
+
+    const auto &children = this->nodes[node].children;
+    const auto heightDifference = this->nodes[children[1]].height - this->nodes[children[0]].height;
+    if (heightDifference > 1) {
+        return this->rotate(node, 1);
+    }
+    if (heightDifference < -1) {
+        return this->rotate(node, 0);
+    }
+    return node;
+}
+
+// Lifts the taller child into the place of node. The taller of its own
+// children stays below it and the other one moves under node.
+AabbTree::ProxyId AabbTree::rotate(ProxyId node, int tallChild) {
+    const auto lifted = this->nodes[node].children[tallChild];
+    const auto f = this->nodes[lifted].children[0];
+    const auto g = this->nodes[lifted].children[1];
+
+    // Swap node and lifted
+    const auto parent = this->nodes[node].parent;
+    this->nodes[lifted].parent = parent;
+    this->nodes[lifted].children[0] = node;
+    this->nodes[node].parent = lifted;
+    if (parent == NULL_PROXY) {
+        this->root = lifted;
+    } else {
+        auto &children = this->nodes[parent].children;
+        children[children[0] == node ? 0 : 1] = lifted;
+    }
+
+    const auto keep = this->nodes[f].height > this->nodes[g].height ? f : g;
+    const auto move = keep == f ? g : f;
+    this->nodes[lifted].children[1] = keep;
+    this->nodes[node].children[tallChild] = move;
+    this->nodes[move].parent = node;
+
+    auto &n = this->nodes[node];
+    n.bounds = merge(this->nodes[n.children[0]].bounds, this->nodes[n.children[1]].bounds);
+    n.height = 1 + std::max(this->nodes[n.children[0]].height, this->nodes[n.children[1]].height);
+
+    auto &l = this->nodes[lifted];
+    l.bounds = merge(n.bounds, this->nodes[keep].bounds);
+    l.height = 1 + std::max(n.height, this->nodes[keep].height);
+    return lifted;
+}
+
+void AabbTree::appendLeaves(ProxyId node, std::vector<unsigned int> &userData, QueryStats *stats) const {
+    if (this->isLeaf(node)) {
+        userData.push_back(this->nodes[node].userData);
+        if (stats) {
+            ++stats->numVisible;
+        }
+        return;
+    }
+    this->appendLeaves(this->nodes[node].children[0], userData, stats);
+    this->appendLeaves(this->nodes[node].children[1], userData, stats);
+}
+
+} // namespace lgl
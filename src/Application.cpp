@@ -0,0 +1,46 @@
+#include <lgl/Application.h>
+
+#include <cassert>
+#include <cmath>
+
+namespace lgl {
+
+Application::Application(Duration timestep, unsigned int maxUpdatesPerFrame) :
+    timestep(timestep),
+    maxUpdatesPerFrame(maxUpdatesPerFrame) {
+
+    assert(("Timestep must be positive", timestep.count() > 0.0f));
+    assert(("Frames must run at least one update", maxUpdatesPerFrame > 0));
+}
+
+void Application::run() {
+    using Clock = std::chrono::steady_clock;
+
+    this->stats = Stats();
+    auto lastTime = Clock::now();
+    Duration accumulator(0.0f);
+    while (this->isRunning()) {
+        const auto currentTime = Clock::now();
+        accumulator += currentTime - lastTime;
+        lastTime = currentTime;
+
+        auto numUpdates = 0u;
+        while (accumulator >= this->timestep && numUpdates < this->maxUpdatesPerFrame) {
+            this->update(this->timestep);
+            accumulator -= this->timestep;
+            ++numUpdates;
+        }
+        this->stats.numUpdates += numUpdates;
+
+        // Drop whole steps the frame could not catch up on
+        if (accumulator >= this->timestep) {
+            this->stats.numDroppedUpdates += static_cast<unsigned long>(accumulator / this->timestep);
+            accumulator = Duration(std::fmod(accumulator.count(), this->timestep.count()));
+        }
+
+        this->render(accumulator / this->timestep);
+        ++this->stats.numFrames;
+    }
+}
+
+} // namespace lgl
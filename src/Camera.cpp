@@ -26,7 +26,20 @@ void Camera::updateProjectionMatrix() {
                                               this->nearPlane, this->farPlane);
 }
 
+glm::mat4 Camera::getViewMatrix() const {
+    return this->getRenderFrame().getViewMatrix();
+}
+
+Frame Camera::getRenderFrame() const {
+    if (!this->hasPreviousFrame || this->renderInterpolation >= 1.0f) {
+        return this->frame;
+    }
+    return interpolate(this->previousFrame, this->frame, this->renderInterpolation);
+}
+
 void Camera::onUpdate(Duration duration) {
+    this->previousFrame = this->frame;
+    this->hasPreviousFrame = true;
     if (glm::length2(this->localLinearVelocity) > std::numeric_limits<float>::epsilon()) {
         this->translateInLocalFrame(this->localLinearVelocity * duration.count());
     }
@@ -0,0 +1,57 @@
+#include <lgl/CommandList.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include <lgl/Mesh.h>
+#include <lgl/ShaderProgram.h>
+
+namespace {
+
+constexpr unsigned int DEPTH_BITS = 20;
+constexpr unsigned int VERTEX_ARRAY_BITS = 12;
+constexpr unsigned int MATERIAL_BITS = 16;
+constexpr unsigned int PROGRAM_BITS = 12;
+
+std::uint64_t packBits(std::uint64_t key, std::uint64_t value, unsigned int bits) {
+    return (key << bits) | (value & ((std::uint64_t(1) << bits) - 1));
+}
+
+// Ids wider than their field only share a slot in the key, which can cost
+// extra state changes but never skips one, since replaying compares the
+// state itself rather than the key
+std::uint64_t makeKey(unsigned int pass, const lgl::ShaderProgram &shaderProgram,
+                      const lgl::Mesh &mesh, float depth) {
+    const auto maxDepth = (1u << DEPTH_BITS) - 1;
+    const auto quantizedDepth = static_cast<std::uint64_t>(std::min(std::max(depth, 0.0f), 1.0f) * maxDepth);
+
+    auto key = static_cast<std::uint64_t>(pass);
+    key = packBits(key, shaderProgram.getId(), PROGRAM_BITS);
+    key = packBits(key, mesh.getMaterialKey(), MATERIAL_BITS);
+    key = packBits(key, mesh.getVertexArray(), VERTEX_ARRAY_BITS);
+    return packBits(key, quantizedDepth, DEPTH_BITS);
+}
+
+} // namespace
+
+namespace lgl {
+
+void CommandList::submit(unsigned int pass, ShaderProgram *shaderProgram, Mesh *mesh,
+                         const glm::mat4 &model, const glm::mat3 &normal, float depth) {
+    assert(("Render pass out of range", pass < MAX_NUM_PASSES));
+
+    this->submit(makeKey(pass, *shaderProgram, *mesh, depth), shaderProgram, mesh, model, normal);
+}
+
+void CommandList::submit(std::uint64_t key, ShaderProgram *shaderProgram, Mesh *mesh,
+                         const glm::mat4 &model, const glm::mat3 &normal) {
+    this->packets.push_back({key, shaderProgram, mesh,
+                             this->uniforms.create<DrawUniforms>(DrawUniforms{model, normal})});
+}
+
+void CommandList::clear() {
+    this->packets.clear();
+    this->uniforms.reset();
+}
+
+} // namespace lgl
@@ -0,0 +1,23 @@
+#include <lgl/Components.h>
+
+namespace lgl {
+
+glm::mat4 getModelMatrix(const TransformComponent &transform) {
+    const auto rotation = glm::mat3_cast(transform.orientation);
+    glm::mat4 modelMatrix(1.0f);
+    for (auto i = 0; i < 3; ++i) {
+        modelMatrix[i] = glm::vec4(rotation[i] * transform.scale[i], 0.0f);
+    }
+    modelMatrix[3] = glm::vec4(transform.position, 1.0f);
+    return modelMatrix;
+}
+
+void integrate(TransformComponent &transform, const VelocityComponent &velocity, float duration) {
+    transform.position += velocity.linear * duration;
+
+    // dq/dt = 0.5 * (0, angular) * q
+    const auto spin = glm::quat(0.0f, velocity.angular) * transform.orientation;
+    transform.orientation = glm::normalize(transform.orientation + 0.5f * duration * spin);
+}
+
+} // namespace lgl
@@ -5,27 +5,41 @@
 namespace lgl {
 
 glm::mat4 Frame::getModelMatrix() const {
-    glm::mat4 modelMatrix(this->orientation);
+    const auto orientation = this->getOrientation();
+    glm::mat4 modelMatrix;
     for (auto i = 0; i < 3; ++i) {
-        modelMatrix[3][i] = this->position[i];
+        modelMatrix[i] = glm::vec4(orientation[i] * this->scale[i], 0.0f);
     }
-    return glm::scale(modelMatrix, this->scale);
+    modelMatrix[3] = glm::vec4(this->position, 1.0f);
+    return modelMatrix;
 }
 
 glm::mat4 Frame::getViewMatrix() const {
     return glm::lookAt(this->position,
-                       this->position + this->orientation[0],
-                       this->orientation[2]);
+                       this->position + this->getOrientationX(),
+                       this->getOrientationZ());
 }
 
 void Frame::setScale(const glm::vec3 &scale) {
     this->scale = scale;
-    this->normalMatrixIsValid = false;
+    ++this->version;
 }
 
 void Frame::setPosition(const glm::vec3 &position) {
     this->position = position;
-    this->normalMatrixIsValid = false;
+    ++this->version;
+}
+
+void Frame::setOrientation(const glm::quat &orientation) {
+    this->orientation = glm::normalize(orientation);
+    ++this->version;
+}
+
+void Frame::composeOrientation(const glm::quat &orientation) {
+    // Products of unit quaternions stay within rounding error of unit length,
+    // so one Newton step towards 1 / length renormalizes without a sqrt
+    this->orientation = orientation * (1.5f - 0.5f * glm::dot(orientation, orientation));
+    ++this->version;
 }
 
 void Frame::translate(const glm::vec3 &translation) {
@@ -37,30 +51,36 @@ void Frame::translateInLocalFrame(const glm::vec3 &translation) {
 }
 
 void Frame::rotate(float angle_rad, const glm::vec3 &axis) {
-    this->orientation = static_cast<glm::mat3>(glm::rotate(glm::mat4(1.0f), angle_rad, axis)) *
-            this->orientation;
-    this->normalMatrixIsValid = false;
+    this->composeOrientation(glm::angleAxis(angle_rad, glm::normalize(axis)) * this->orientation);
 }
 
 void Frame::rotateInLocalFrame(float angle_rad, const glm::vec3 &axis) {
-    this->orientation = static_cast<glm::mat3>(glm::rotate(glm::mat4(this->orientation),
-                                                           angle_rad, axis));
-    this->normalMatrixIsValid = false;
+    this->composeOrientation(this->orientation * glm::angleAxis(angle_rad, glm::normalize(axis)));
 }
 
 void Frame::lookAtPoint(const glm::vec3 &point) {
-    this->orientation[0] = glm::normalize(point - this->position);
-    this->orientation[1] = glm::cross(glm::vec3(0.0f, 0.0f, 1.0f), this->orientation[0]);
-    this->orientation[2] = glm::cross(this->orientation[0], this->orientation[1]);
-    this->normalMatrixIsValid = false;
+    glm::mat3 orientation;
+    orientation[0] = glm::normalize(point - this->position);
+    orientation[1] = glm::normalize(glm::cross(glm::vec3(0.0f, 0.0f, 1.0f), orientation[0]));
+    orientation[2] = glm::cross(orientation[0], orientation[1]);
+    this->setOrientation(glm::quat_cast(orientation));
 }
 
 glm::mat3 Frame::getNormalMatrix() const {
-    if (!this->normalMatrixIsValid) {
-        this->normalMatrix = glm::transpose(glm::inverse(this->getModelMatrix()));
-        this->normalMatrixIsValid = true;
+    // transpose(inverse(R * S)) = R * inverse(S) for a rotation R
+    auto normalMatrix = this->getOrientation();
+    for (auto i = 0; i < 3; ++i) {
+        normalMatrix[i] /= this->scale[i];
     }
-    return this->normalMatrix;
+    return normalMatrix;
+}
+
+Frame interpolate(const Frame &previous, const Frame &current, float alpha) {
+    Frame frame;
+    frame.setScale(glm::mix(previous.getScale(), current.getScale(), alpha));
+    frame.setPosition(glm::mix(previous.getPosition(), current.getPosition(), alpha));
+    frame.setOrientation(glm::slerp(previous.getOrientationQuaternion(), current.getOrientationQuaternion(), alpha));
+    return frame;
 }
 
 } // namespace lgl
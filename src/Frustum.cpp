@@ -0,0 +1,52 @@
+#include <lgl/Frustum.h>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+namespace lgl {
+
+Frustum::Frustum(const glm::mat4 &matrix) {
+    // Gribb-Hartmann: every plane is the last row of the matrix plus or minus
+    // one of the others
+    const auto getRow = [&matrix](int i){ return glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]); };
+    for (auto i = 0; i < 3; ++i) {
+        this->planes[2 * i] = getRow(3) + getRow(i);
+        this->planes[2 * i + 1] = getRow(3) - getRow(i);
+    }
+
+    // Normalize so that plane equations give distances
+    for (auto &plane : this->planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+bool Frustum::intersectsSphere(const glm::vec3 &center, float radius) const {
+    for (const auto &plane : this->planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Frustum::Containment Frustum::testBox(const Aabb &box) const {
+    const auto center = 0.5f * (box.min + box.max);
+    const auto extent = 0.5f * (box.max - box.min);
+
+    auto containment = Containment::Inside;
+    for (const auto &plane : this->planes) {
+        // Projected half extent of the box onto the plane normal
+        const auto normal = glm::vec3(plane);
+        const auto radius = glm::dot(extent, glm::abs(normal));
+        const auto distance = glm::dot(normal, center) + plane.w;
+        if (distance < -radius) {
+            return Containment::Outside;
+        }
+        if (distance < radius) {
+            containment = Containment::Intersecting;
+        }
+    }
+    return containment;
+}
+
+} // namespace lgl
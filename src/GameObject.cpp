@@ -1,22 +1,35 @@
 #include <lgl/GameObject.h>
 
 #include <algorithm>
+#include <cassert>
 #include <functional>
 #include <iterator>
+#include <map>
 #include <numeric>
+#include <tuple>
 #include <utility>
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/matrix.hpp>
 #include <glm/vec2.hpp>
 
+#include <lgl/CommandList.h>
 #include <lgl/Exception.h>
+#include <lgl/MultiDrawBatch.h>
 #include <lgl/ShaderProgram.h>
 #include <lgl/Texture2D.h>
+#include <lgl/UniformRingBuffer.h>
 #include <lgl/Vertex.h>
 
 namespace {
 
+// Keeps the projected error finite when the camera is inside the object
+constexpr float MIN_LOD_DISTANCE = 0.01f;
+
 std::vector<std::string> loadMaterialTextures(aiMaterial *material,
                                                  aiTextureType type) {
     std::vector<std::string> textures;
@@ -29,54 +42,191 @@ std::vector<std::string> loadMaterialTextures(aiMaterial *material,
     return textures;
 }
 
-lgl::Mesh processMesh(const aiMesh *mesh, const aiScene *scene, const std::string &dir) {
-    // Copy vertex data
+// Geometry and texture pathnames of an aiMesh in model space
+struct MeshData {
     std::vector<lgl::Vertex> vertices;
-    vertices.reserve(mesh->mNumVertices);
+    std::vector<unsigned int> indices;
+    std::vector<std::string> diffuseTextures;
+    std::vector<std::string> specularTextures;
+    float shine;
+    unsigned int primitiveTypes;
+    lgl::SceneGraph::NodeId node;
+};
+
+glm::mat4 toMat4(const aiMatrix4x4 &matrix) {
+    // Assimp matrices are row major
+    return glm::transpose(glm::make_mat4(&matrix.a1));
+}
+
+MeshData loadMeshData(const aiMesh *mesh, const aiScene *scene, const std::string &dir,
+                      const aiMatrix4x4 &transform) {
+    MeshData meshData;
+    meshData.primitiveTypes = mesh->mPrimitiveTypes;
+
+    // Copy vertex data, transformed from the node into model space
+    auto normalTransform = aiMatrix3x3(transform);
+    normalTransform.Inverse().Transpose();
+
+    meshData.vertices.reserve(mesh->mNumVertices);
     for (auto i = 0u; i < mesh->mNumVertices; ++i) {
-        vertices.emplace_back(glm::vec3{mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z},
-                              glm::vec3{mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z},
-                              mesh->mTextureCoords[0] ?
-                                glm::vec2{mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y} :
-                                glm::vec2(0.0f));
+        const auto position = transform * mesh->mVertices[i];
+        auto normal = normalTransform * mesh->mNormals[i];
+        normal.Normalize();
+        meshData.vertices.emplace_back(glm::vec3{position.x, position.y, position.z},
+                                       glm::vec3{normal.x, normal.y, normal.z},
+                                       mesh->mTextureCoords[0] ?
+                                         glm::vec2{mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y} :
+                                         glm::vec2(0.0f));
     }
 
-    // Copy index data
-    std::vector<unsigned int> indices;
+    // Copy index data, keeping triangles front facing under mirroring transforms
+    auto &indices = meshData.indices;
     const auto numIndices = std::accumulate(mesh->mFaces, mesh->mFaces + mesh->mNumFaces, 0u,
                                             [](const auto sum, const auto &face){ return sum + face.mNumIndices; });
     indices.reserve(numIndices);
+    const auto isMirrored = transform.Determinant() < 0.0f;
     std::for_each(mesh->mFaces, mesh->mFaces + mesh->mNumFaces,
-                  [&indices](const auto& face){ indices.insert(indices.cend(),
-                                                               face.mIndices,
-                                                               face.mIndices + face.mNumIndices); });
+                  [&indices, isMirrored](const auto& face){
+        if (isMirrored) {
+            indices.insert(indices.cend(),
+                           std::reverse_iterator<const unsigned int *>(face.mIndices + face.mNumIndices),
+                           std::reverse_iterator<const unsigned int *>(face.mIndices));
+        } else {
+            indices.insert(indices.cend(), face.mIndices, face.mIndices + face.mNumIndices);
+        }
+    });
 
+    // Collect texture pathnames
+    const auto material = scene->mMaterials[mesh->mMaterialIndex];
+    meshData.diffuseTextures = loadMaterialTextures(material, aiTextureType_DIFFUSE);
+    meshData.specularTextures = loadMaterialTextures(material, aiTextureType_SPECULAR);
+    if (material->Get(AI_MATKEY_SHININESS, meshData.shine) != AI_SUCCESS || meshData.shine <= 0.0f) {
+        meshData.shine = lgl::DEFAULT_SHINE;
+    }
 
-    // Load textures
-    std::vector<std::string> diffuseTextures;
-    std::vector<std::string> specularTextures;
-    if (mesh->mMaterialIndex >= 0) {
-        const auto material = scene->mMaterials[mesh->mMaterialIndex];
-        diffuseTextures = loadMaterialTextures(material, aiTextureType_DIFFUSE);
-        specularTextures = loadMaterialTextures(material, aiTextureType_SPECULAR);
+    const auto prependDir = [&dir](const std::string &filename){ return dir + "/" + filename; };
+    std::transform(meshData.diffuseTextures.begin(), meshData.diffuseTextures.end(),
+                   meshData.diffuseTextures.begin(), prependDir);
+    std::transform(meshData.specularTextures.begin(), meshData.specularTextures.end(),
+                   meshData.specularTextures.begin(), prependDir);
 
-        const auto prependDir = [&dir](const std::string &filename){ return dir + "/" + filename; };
-        std::transform(diffuseTextures.begin(), diffuseTextures.end(),
-                       diffuseTextures.begin(), prependDir);
-        std::transform(specularTextures.begin(), specularTextures.end(),
-                       specularTextures.begin(), prependDir);
+    return meshData;
+}
+
+// Mirrors the node hierarchy in sceneGraph, or bakes node transforms into the
+// vertices of meshes attached to parentNode without one
+void processNode(const aiNode *node, const aiScene *scene, const std::string &dir,
+                 const aiMatrix4x4 &parentTransform, lgl::SceneGraph::NodeId parentNode,
+                 lgl::SceneGraph *sceneGraph, std::vector<MeshData> &meshData) {
+    auto transform = parentTransform * node->mTransformation;
+    auto graphNode = parentNode;
+    if (sceneGraph) {
+        transform = aiMatrix4x4();
+        graphNode = sceneGraph->createNode(parentNode, toMat4(node->mTransformation));
+    }
+
+    std::transform(node->mMeshes, node->mMeshes + node->mNumMeshes,
+                   std::back_inserter(meshData),
+                   [scene, &dir, &transform, graphNode](const auto i){
+        auto m = loadMeshData(scene->mMeshes[i], scene, dir, transform);
+        m.node = graphNode;
+        return m;
+    });
+
+    std::for_each(node->mChildren, node->mChildren + node->mNumChildren,
+                  [scene, &dir, &transform, graphNode, sceneGraph, &meshData](const auto child){
+        processNode(child, scene, dir, transform, graphNode, sceneGraph, meshData);
+    });
+}
+
+// Concatenates meshes with the same material and primitive types
+std::vector<MeshData> batchMeshData(std::vector<MeshData> meshData) {
+    using BatchKey = std::tuple<unsigned int, std::vector<std::string>, std::vector<std::string>, float>;
+    std::map<BatchKey, std::size_t> batchIndices;
+
+    std::vector<MeshData> batches;
+    for (auto &m : meshData) {
+        const auto key = std::make_tuple(m.primitiveTypes, m.diffuseTextures, m.specularTextures, m.shine);
+        const auto batchIndex = batchIndices.find(key);
+        if (batchIndex == batchIndices.end()) {
+            batchIndices.emplace(key, batches.size());
+            batches.push_back(std::move(m));
+            continue;
+        }
+
+        auto &batch = batches[batchIndex->second];
+        const auto baseVertex = static_cast<unsigned int>(batch.vertices.size());
+        batch.vertices.insert(batch.vertices.cend(), m.vertices.cbegin(), m.vertices.cend());
+        std::transform(m.indices.cbegin(), m.indices.cend(), std::back_inserter(batch.indices),
+                       [baseVertex](const auto i){ return i + baseVertex; });
+    }
+    return batches;
+}
+
+// Also fills occluder with the positions and coarsest level of detail, unless null
+lgl::Mesh createMesh(MeshData &meshData, lgl::VertexFormat vertexFormat, lgl::GeometryPool *geometryPool,
+                     const lgl::ModelSettings &settings, lgl::MeshOptimizationStats &optimizationStats,
+                     lgl::OccluderMesh *occluder) {
+    auto &vertices = meshData.vertices;
+    auto &indices = meshData.indices;
+
+    // Merge duplicate vertices, which importers like OBJ emit per face corner
+    lgl::weldVertices(vertices, indices);
+
+    // Reorder for vertex cache, overdraw and vertex fetch efficiency, then
+    // simplify into coarser levels of detail sharing the same vertices
+    std::vector<lgl::LodLevel> coarserLods;
+    std::vector<lgl::Meshlet> meshlets;
+    if (meshData.primitiveTypes == aiPrimitiveType_TRIANGLE) {
+        const auto stats = lgl::optimizeMesh(vertices, indices);
+        optimizationStats.before += stats.before;
+        optimizationStats.after += stats.after;
+
+        meshlets = lgl::buildMeshlets(vertices, indices, settings.meshlets);
+        coarserLods = lgl::generateLods(vertices, indices, settings.lods);
+        for (auto &lod : coarserLods) {
+            lod.indices = lgl::optimizeVertexCache(lod.indices, vertices.size());
+        }
+    }
+
+    if (occluder && meshData.primitiveTypes == aiPrimitiveType_TRIANGLE) {
+        occluder->positions.resize(vertices.size());
+        std::transform(vertices.cbegin(), vertices.cend(), occluder->positions.begin(),
+                       [](const auto &v){ return v.position; });
+        occluder->indices = coarserLods.empty() ? indices : coarserLods.back().indices;
+    }
+
+    const auto &diffuseTextures = meshData.diffuseTextures;
+    const auto &specularTextures = meshData.specularTextures;
+    if (geometryPool) {
+        return lgl::Mesh(vertices, indices,
+                         (std::vector<lgl::Texture2D>(diffuseTextures.cbegin(), diffuseTextures.cend())),
+                         std::vector<lgl::Texture2D>(specularTextures.cbegin(), specularTextures.cend()),
+                         geometryPool, coarserLods, meshlets);
     }
 
     return lgl::Mesh(vertices, indices,
                      (std::vector<lgl::Texture2D>(diffuseTextures.cbegin(), diffuseTextures.cend())),
-                     std::vector<lgl::Texture2D>(specularTextures.cbegin(), specularTextures.cend()));
+                     std::vector<lgl::Texture2D>(specularTextures.cbegin(), specularTextures.cend()),
+                     vertexFormat, coarserLods, meshlets);
 }
 
 } // namespace
 
 namespace lgl {
 
-GameObject::GameObject(const std::string &pathname) {
+GameObject::GameObject(const std::string &pathname, VertexFormat vertexFormat,
+                       const ModelSettings &settings) {
+    this->load(pathname, vertexFormat, nullptr, settings);
+}
+
+GameObject::GameObject(const std::string &pathname, GeometryPool *geometryPool,
+                       const ModelSettings &settings) {
+    this->load(pathname, geometryPool->getVertexFormat(), geometryPool, settings);
+}
+
+void GameObject::load(const std::string &pathname, VertexFormat vertexFormat, GeometryPool *geometryPool,
+                      const ModelSettings &settings) {
     Assimp::Importer importer;
     const auto scene = importer.ReadFile(pathname,
                                          aiProcess_Triangulate | aiProcess_FlipUVs);
@@ -87,29 +237,209 @@ GameObject::GameObject(const std::string &pathname) {
     }
 
     const auto dir = pathname.substr(0, pathname.find_last_of("/\\"));
-    this->processNode(scene->mRootNode, scene, dir);
-}
+    std::vector<MeshData> meshData;
+    processNode(scene->mRootNode, scene, dir, aiMatrix4x4(), SceneGraph::ROOT_NODE,
+                settings.isStaticBatched ? nullptr : &this->sceneGraph, meshData);
 
-void GameObject::processNode(const aiNode *node, const aiScene *scene, const std::string &dir) {
-    this->meshes.reserve(this->meshes.size() + node->mNumMeshes);
-    std::transform(node->mMeshes, node->mMeshes + node->mNumMeshes,
-                   std::back_inserter(this->meshes),
-                   [scene, &dir](const auto i){ return processMesh(scene->mMeshes[i], scene, dir); });
+    // Batched meshes never move relative to each other, so those sharing
+    // textures can be drawn as one
+    if (settings.isStaticBatched) {
+        meshData = batchMeshData(std::move(meshData));
+    }
 
-    std::for_each(node->mChildren, node->mChildren + node->mNumChildren,
-                  [this, scene, &dir](const auto child){ this->processNode(child, scene, dir); });
+    this->meshes.reserve(meshData.size());
+    this->meshNodes.reserve(meshData.size());
+    if (settings.isOccluder) {
+        this->occluders.resize(meshData.size());
+    }
+    for (auto i = 0u; i < meshData.size(); ++i) {
+        auto &m = meshData[i];
+        this->meshes.push_back(createMesh(m, vertexFormat, geometryPool, settings,
+                                          this->meshOptimizationStats,
+                                          settings.isOccluder ? &this->occluders[i] : nullptr));
+        this->meshes.back().setShine(m.shine);
+        this->meshNodes.push_back(m.node);
+    }
+}
+
+std::size_t GameObject::getNumTriangles() const {
+    return std::accumulate(this->meshes.cbegin(), this->meshes.cend(), std::size_t(0),
+                           [](const auto sum, const auto &m){ return sum + m.getNumTriangles(); });
 }
 
 void GameObject::onUpdate(Duration duration) {
+    this->previousFrame = this->frame;
+    this->hasPreviousFrame = true;
+}
 
+Frame GameObject::getRenderFrame() const {
+    if (!this->hasPreviousFrame || this->renderInterpolation >= 1.0f) {
+        return this->frame;
+    }
+    return interpolate(this->previousFrame, this->frame, this->renderInterpolation);
 }
 
 void GameObject::render(ShaderProgram *shaderProgram) {
-    shaderProgram->setUniform("model", this->frame.getModelMatrix());
-    shaderProgram->setUniform("normal", this->frame.getNormalMatrix());
+    this->updateTransforms();
+
+    for (auto i = 0u; i < this->meshes.size(); ++i) {
+        shaderProgram->setUniform("model", this->sceneGraph.getWorldTransform(this->meshNodes[i]));
+        shaderProgram->setUniform("normal", this->sceneGraph.getNormalMatrix(this->meshNodes[i]));
+        this->meshes[i].render(shaderProgram);
+    }
+}
+
+void GameObject::render(ShaderProgram *shaderProgram, const Camera &camera) {
+    this->selectLods(camera);
+    this->updateTransforms();
+
+    // Meshlets are culled in the space of each mesh's node
+    const auto viewProjectionMatrix = camera.getProjectionMatrix() * camera.getViewMatrix();
+    const auto worldCameraPosition = camera.getRenderFrame().getPosition();
+    for (auto i = 0u; i < this->meshes.size(); ++i) {
+        const auto &worldTransform = this->sceneGraph.getWorldTransform(this->meshNodes[i]);
+        const Frustum frustum(viewProjectionMatrix * worldTransform);
+        const auto cameraPosition = glm::vec3(glm::inverse(worldTransform) * glm::vec4(worldCameraPosition, 1.0f));
+
+        shaderProgram->setUniform("model", worldTransform);
+        shaderProgram->setUniform("normal", this->sceneGraph.getNormalMatrix(this->meshNodes[i]));
+        this->meshes[i].render(shaderProgram, frustum, cameraPosition);
+    }
+}
+
+void GameObject::render(ShaderProgram *shaderProgram, UniformRingBuffer &uniformRingBuffer) {
+    const auto binding = shaderProgram->getUniformBlockBinding("DrawUniforms");
+    assert(("Shader program lacks DRAW_UNIFORM_BLOCK", binding >= 0));
+
+    this->updateTransforms();
+
+    this->drawUniformOffsets.resize(this->meshes.size());
+    for (auto i = 0u; i < this->meshes.size(); ++i) {
+        uniformRingBuffer.write(this->meshes[i].getDrawUniformBlock(
+                                    this->sceneGraph.getWorldTransform(this->meshNodes[i]),
+                                    this->sceneGraph.getNormalMatrix(this->meshNodes[i])),
+                                &this->drawUniformOffsets[i]);
+    }
+    uniformRingBuffer.flush();
+
+    for (auto i = 0u; i < this->meshes.size(); ++i) {
+        uniformRingBuffer.bindRange(static_cast<unsigned int>(binding), this->drawUniformOffsets[i],
+                                    sizeof(DrawUniformBlock));
+        this->meshes[i].bindMaterial(shaderProgram);
+        this->meshes[i].draw();
+    }
+}
+
+void GameObject::submit(CommandList &commandList, ShaderProgram *shaderProgram, const Camera &camera,
+                        unsigned int pass) {
+    this->selectLods(camera);
+    this->updateTransforms();
+
+    const auto cameraPosition = camera.getRenderFrame().getPosition();
+    for (auto i = 0u; i < this->meshes.size(); ++i) {
+        const auto &worldTransform = this->sceneGraph.getWorldTransform(this->meshNodes[i]);
+        const auto distance = glm::distance(cameraPosition, glm::vec3(worldTransform[3]));
+        commandList.submit(pass, shaderProgram, &this->meshes[i], worldTransform,
+                           this->sceneGraph.getNormalMatrix(this->meshNodes[i]),
+                           distance / camera.getFarPlane());
+    }
+}
+
+void GameObject::submit(MultiDrawBatch &multiDrawBatch, const Camera &camera) {
+    this->selectLods(camera);
+    this->updateTransforms();
+
+    for (auto i = 0u; i < this->meshes.size(); ++i) {
+        multiDrawBatch.add(&this->meshes[i], this->sceneGraph.getWorldTransform(this->meshNodes[i]),
+                           this->sceneGraph.getNormalMatrix(this->meshNodes[i]));
+    }
+}
+
+void GameObject::renderDepth(ShaderProgram *shaderProgram) {
+    this->updateTransforms();
+
+    for (auto i = 0u; i < this->meshes.size(); ++i) {
+        shaderProgram->setUniform("model", this->sceneGraph.getWorldTransform(this->meshNodes[i]));
+        this->meshes[i].renderDepth(shaderProgram);
+    }
+}
+
+void GameObject::renderInstanced(ShaderProgram *shaderProgram, const TransformBatch &instances) {
+    assert(("Instanced models must be statically batched",
+            std::all_of(this->meshNodes.cbegin(), this->meshNodes.cend(),
+                        [](const auto node){ return node == SceneGraph::ROOT_NODE; })));
+    if (instances.getSize() == 0) {
+        return;
+    }
+
+    if (!this->instanceBuffer) {
+        this->instanceBuffer = BufferHandle::create();
+    }
+    if (&instances != this->uploadedInstances || instances.getVersion() != this->uploadedInstancesVersion) {
+        instances.writeInstanceBuffer(this->instanceBuffer.get());
+        this->uploadedInstances = &instances;
+        this->uploadedInstancesVersion = instances.getVersion();
+    }
+
+    for (auto &m : this->meshes) {
+        m.renderInstanced(shaderProgram, this->instanceBuffer.get(), instances.getSize());
+    }
+}
+
+void GameObject::renderInstanced(ShaderProgram *shaderProgram, const std::vector<Frame> &instances) {
+    this->frameInstances.clear();
+    for (const auto &f : instances) {
+        this->frameInstances.add(f);
+    }
+    this->renderInstanced(shaderProgram, this->frameInstances);
+}
+
+void GameObject::rasterizeOccluder(OcclusionCuller &occlusionCuller) {
+    this->updateTransforms();
+    for (auto i = 0u; i < this->occluders.size(); ++i) {
+        occlusionCuller.addOccluder(this->occluders[i], this->sceneGraph.getWorldTransform(this->meshNodes[i]));
+    }
+}
+
+const Aabb &GameObject::getWorldBounds() {
+    const auto version = this->getTransformVersion();
+    if (!this->worldBoundsAreValid || version != this->worldBoundsVersion) {
+        this->updateTransforms();
+        this->worldBounds = Aabb();
+        for (auto i = 0u; i < this->meshes.size(); ++i) {
+            this->worldBounds = merge(this->worldBounds,
+                                      transform(this->meshes[i].getBounds(),
+                                                this->sceneGraph.getWorldTransform(this->meshNodes[i])));
+        }
+
+        // Updating the transforms may have bumped the version
+        this->worldBoundsVersion = this->getTransformVersion();
+        this->worldBoundsAreValid = true;
+    }
+    return this->worldBounds;
+}
+
+void GameObject::updateTransforms() {
+    // The frame places the root of the scene graph
+    const auto modelMatrix = this->getRenderFrame().getModelMatrix();
+    if (modelMatrix != this->sceneGraph.getLocalTransform(SceneGraph::ROOT_NODE)) {
+        this->sceneGraph.setLocalTransform(SceneGraph::ROOT_NODE, modelMatrix);
+    }
+    this->sceneGraph.update();
+}
+
+void GameObject::selectLods(const Camera &camera) {
+    // Fraction of the viewport height covered by one model space unit at the
+    // distance of the object
+    const auto renderFrame = this->getRenderFrame();
+    const auto scale = renderFrame.getScale();
+    const auto distance = std::max(glm::distance(camera.getRenderFrame().getPosition(), renderFrame.getPosition()),
+                                   MIN_LOD_DISTANCE);
+    const auto errorScale = std::max({scale.x, scale.y, scale.z}) *
+                            camera.getProjectionMatrix()[1][1] / (2.0f * distance);
 
     std::for_each(this->meshes.begin(), this->meshes.end(),
-                  [shaderProgram](auto &m){ m.render(shaderProgram); });
+                  [this, errorScale](auto &m){ m.selectLod(errorScale, this->maxLodError); });
 }
 
 } // namespace lgl
@@ -0,0 +1,282 @@
+#include <lgl/GeometryPool.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include <glad/glad.h>
+
+#include <lgl/GlState.h>
+
+namespace {
+
+lgl::GeometryPool::Stats stats;
+
+constexpr std::size_t MAX_SHORT_INDEX_VERTICES = std::numeric_limits<std::uint16_t>::max() + 1u;
+
+lgl::BufferHandle createBuffer(std::size_t size) {
+    auto buffer = lgl::BufferHandle::create();
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.get());
+    glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+    return buffer;
+}
+
+void copyBuffer(unsigned int source, std::size_t sourceOffset,
+                unsigned int destination, std::size_t destinationOffset,
+                std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, source);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                        sourceOffset, destinationOffset, size);
+}
+
+} // namespace
+
+namespace lgl {
+
+void GeometryPool::AllocationDeleter::operator()(AllocationId *id) const {
+    if (this->geometryPool) {
+        this->geometryPool->free(*id);
+    }
+    delete id;
+}
+
+GeometryPool::GeometryPool(VertexFormat vertexFormat,
+                           std::size_t vertexCapacity,
+                           std::size_t indexCapacity) :
+    vao(VertexArrayHandle::create()),
+    vbo(createBuffer(vertexCapacity * getVertexSize(vertexFormat))),
+    ebo(createBuffer(indexCapacity * sizeof(std::uint16_t))),
+    vertexFormat(vertexFormat),
+    vertexSize(getVertexSize(vertexFormat)),
+    indexType(GL_UNSIGNED_SHORT),
+    indexSize(sizeof(std::uint16_t)),
+    vertexRanges(vertexCapacity),
+    indexRanges(indexCapacity) {
+
+    assert(("Geometry pools hold interleaved vertices only", vertexFormat != VertexFormat::Split));
+
+    this->setupVertexArray();
+}
+
+GeometryPool::AllocationPtr GeometryPool::allocate(const void *vertexData, std::size_t numVertices,
+                                                   const std::vector<unsigned int> &indices) {
+    if (this->indexType == GL_UNSIGNED_SHORT && numVertices > MAX_SHORT_INDEX_VERTICES) {
+        this->widenIndices();
+    }
+
+    // Grow the buffers geometrically when no free range is large enough
+    Allocation allocation{{0, numVertices}, {0, indices.size()}};
+    if (!this->vertexRanges.allocate(numVertices, &allocation.vertices.offset)) {
+        const auto vertexCapacity = this->vertexRanges.getCapacity();
+        this->resizeBuffers(std::max(2 * vertexCapacity, vertexCapacity + numVertices),
+                            this->indexRanges.getCapacity());
+        this->vertexRanges.allocate(numVertices, &allocation.vertices.offset);
+    }
+    if (!this->indexRanges.allocate(indices.size(), &allocation.indices.offset)) {
+        const auto indexCapacity = this->indexRanges.getCapacity();
+        this->resizeBuffers(this->vertexRanges.getCapacity(),
+                            std::max(2 * indexCapacity, indexCapacity + indices.size()));
+        this->indexRanges.allocate(indices.size(), &allocation.indices.offset);
+    }
+
+    // Copy data into GPU
+    glBindBuffer(GL_ARRAY_BUFFER, this->vbo.get());
+    glBufferSubData(GL_ARRAY_BUFFER, allocation.vertices.offset * this->vertexSize,
+                    numVertices * this->vertexSize, vertexData);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, this->ebo.get());
+    if (this->indexType == GL_UNSIGNED_SHORT) {
+        const std::vector<std::uint16_t> shortIndices(indices.cbegin(), indices.cend());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.indices.offset * this->indexSize,
+                        shortIndices.size() * this->indexSize, shortIndices.data());
+    } else {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.indices.offset * this->indexSize,
+                        indices.size() * this->indexSize, indices.data());
+    }
+
+    AllocationId id;
+    if (this->freeAllocationIds.empty()) {
+        id = static_cast<AllocationId>(this->allocations.size());
+        this->allocations.push_back(allocation);
+        this->isAllocationLive.push_back(true);
+    } else {
+        id = this->freeAllocationIds.back();
+        this->freeAllocationIds.pop_back();
+        this->allocations[id] = allocation;
+        this->isAllocationLive[id] = true;
+    }
+
+    return AllocationPtr(new AllocationId(id), AllocationDeleter{this});
+}
+
+void GeometryPool::free(AllocationId id) {
+    this->vertexRanges.free(this->allocations[id].vertices);
+    this->indexRanges.free(this->allocations[id].indices);
+    this->isAllocationLive[id] = false;
+    this->freeAllocationIds.push_back(id);
+}
+
+void GeometryPool::draw(AllocationId id) {
+    this->draw(id, 0, this->allocations[id].indices.size);
+}
+
+void GeometryPool::draw(AllocationId id, std::size_t firstIndex, std::size_t numIndices) {
+    GlState::bindVertexArray(this->vao.get());
+    ++stats.numDraws;
+
+    const auto &allocation = this->allocations[id];
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(numIndices),
+                             this->indexType,
+                             reinterpret_cast<void *>((allocation.indices.offset + firstIndex) * this->indexSize),
+                             static_cast<GLint>(allocation.vertices.offset));
+}
+
+void GeometryPool::draw(AllocationId id, const std::vector<std::size_t> &firstIndices,
+                        const std::vector<int> &counts) {
+    if (counts.size() == 1) {
+        this->draw(id, firstIndices.front(), counts.front());
+        return;
+    }
+
+    GlState::bindVertexArray(this->vao.get());
+    ++stats.numDraws;
+
+    const auto &allocation = this->allocations[id];
+    this->drawOffsets.resize(firstIndices.size());
+    std::transform(firstIndices.cbegin(), firstIndices.cend(), this->drawOffsets.begin(),
+                   [this, &allocation](const auto firstIndex){
+        return reinterpret_cast<const void *>((allocation.indices.offset + firstIndex) * this->indexSize);
+    });
+    this->drawBaseVertices.assign(counts.size(), static_cast<int>(allocation.vertices.offset));
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts.data(), this->indexType,
+                                  this->drawOffsets.data(), static_cast<GLsizei>(counts.size()),
+                                  this->drawBaseVertices.data());
+}
+
+GeometryPool::DrawCommand GeometryPool::getDrawCommand(AllocationId id, std::size_t firstIndex,
+                                                      std::size_t numIndices) const {
+    const auto &allocation = this->allocations[id];
+    return {static_cast<unsigned int>(numIndices), 1,
+            static_cast<unsigned int>(allocation.indices.offset + firstIndex),
+            static_cast<int>(allocation.vertices.offset), 0};
+}
+
+void GeometryPool::drawInstanced(AllocationId id, std::size_t firstIndex, std::size_t numIndices,
+                                 unsigned int instanceBuffer, std::size_t numInstances) {
+    GlState::bindVertexArray(this->vao.get());
+    ++stats.numDraws;
+
+    // Instance buffers differ between game objects, so they are attached on
+    // every draw
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    setInstanceAttributes();
+
+    const auto &allocation = this->allocations[id];
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(numIndices), this->indexType,
+                                      reinterpret_cast<void *>((allocation.indices.offset + firstIndex) * this->indexSize),
+                                      static_cast<GLsizei>(numInstances),
+                                      static_cast<GLint>(allocation.vertices.offset));
+
+    // The shared vertex array must not keep pointing at the instance buffer,
+    // which is deleted with its game object
+    disableInstanceAttributes();
+}
+
+void GeometryPool::defragment() {
+    auto vertexBuffer = createBuffer(this->vertexRanges.getCapacity() * this->vertexSize);
+    auto indexBuffer = createBuffer(this->indexRanges.getCapacity() * this->indexSize);
+
+    std::size_t numVertices = 0;
+    std::size_t numIndices = 0;
+    for (auto id = 0u; id < this->allocations.size(); ++id) {
+        if (!this->isAllocationLive[id]) {
+            continue;
+        }
+
+        auto &allocation = this->allocations[id];
+        copyBuffer(this->vbo.get(), allocation.vertices.offset * this->vertexSize,
+                   vertexBuffer.get(), numVertices * this->vertexSize,
+                   allocation.vertices.size * this->vertexSize);
+        copyBuffer(this->ebo.get(), allocation.indices.offset * this->indexSize,
+                   indexBuffer.get(), numIndices * this->indexSize,
+                   allocation.indices.size * this->indexSize);
+
+        allocation.vertices.offset = numVertices;
+        allocation.indices.offset = numIndices;
+        numVertices += allocation.vertices.size;
+        numIndices += allocation.indices.size;
+    }
+
+    this->vbo = std::move(vertexBuffer);
+    this->ebo = std::move(indexBuffer);
+
+    this->vertexRanges.reset(numVertices);
+    this->indexRanges.reset(numIndices);
+
+    this->setupVertexArray();
+}
+
+std::size_t GeometryPool::getNumFreeVertices() const {
+    return this->vertexRanges.getNumFree();
+}
+
+std::size_t GeometryPool::getNumFreeIndices() const {
+    return this->indexRanges.getNumFree();
+}
+
+GeometryPool::Stats GeometryPool::getStats() {
+    return stats;
+}
+
+void GeometryPool::resetStats() {
+    stats = Stats();
+}
+
+void GeometryPool::setupVertexArray() {
+    GlState::bindVertexArray(this->vao.get());
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->vbo.get());
+    setVertexAttributes(this->vertexFormat);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo.get());
+}
+
+void GeometryPool::widenIndices() {
+    // Rare and at load time, so the indices make a round trip through the CPU
+    std::vector<std::uint16_t> shortIndices(this->indexRanges.getCapacity());
+    glBindBuffer(GL_COPY_READ_BUFFER, this->ebo.get());
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, shortIndices.size() * sizeof(std::uint16_t), shortIndices.data());
+
+    const std::vector<unsigned int> indices(shortIndices.cbegin(), shortIndices.cend());
+    this->ebo = createBuffer(indices.size() * sizeof(unsigned int));
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0, indices.size() * sizeof(unsigned int), indices.data());
+
+    this->indexType = GL_UNSIGNED_INT;
+    this->indexSize = sizeof(unsigned int);
+    this->setupVertexArray();
+}
+
+void GeometryPool::resizeBuffers(std::size_t vertexCapacity, std::size_t indexCapacity) {
+    if (vertexCapacity != this->vertexRanges.getCapacity()) {
+        auto vertexBuffer = createBuffer(vertexCapacity * this->vertexSize);
+        copyBuffer(this->vbo.get(), 0, vertexBuffer.get(), 0, this->vertexRanges.getCapacity() * this->vertexSize);
+        this->vbo = std::move(vertexBuffer);
+        this->vertexRanges.grow(vertexCapacity);
+    }
+
+    if (indexCapacity != this->indexRanges.getCapacity()) {
+        auto indexBuffer = createBuffer(indexCapacity * this->indexSize);
+        copyBuffer(this->ebo.get(), 0, indexBuffer.get(), 0, this->indexRanges.getCapacity() * this->indexSize);
+        this->ebo = std::move(indexBuffer);
+        this->indexRanges.grow(indexCapacity);
+    }
+
+    this->setupVertexArray();
+}
+
+} // namespace lgl
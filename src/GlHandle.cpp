@@ -0,0 +1,106 @@
+#include <lgl/GlHandle.h>
+
+#include <cassert>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <lgl/GlState.h>
+
+namespace {
+
+bool isQueueEnabled = false;
+std::vector<unsigned int> queuedBuffers;
+std::vector<unsigned int> queuedVertexArrays;
+std::vector<unsigned int> queuedTextures;
+std::vector<unsigned int> queuedShaders;
+std::vector<unsigned int> queuedPrograms;
+
+std::vector<unsigned int> &getQueue(lgl::GlObject kind) {
+    switch (kind) {
+    case lgl::GlObject::Buffer: return queuedBuffers;
+    case lgl::GlObject::VertexArray: return queuedVertexArrays;
+    case lgl::GlObject::Texture: return queuedTextures;
+    case lgl::GlObject::Shader: return queuedShaders;
+    default: return queuedPrograms;
+    }
+}
+
+} // namespace
+
+namespace lgl {
+
+void deleteGlObject(GlObject kind, unsigned int id) {
+    if (isQueueEnabled) {
+        getQueue(kind).push_back(id);
+        return;
+    }
+
+    GlState::onDelete(kind, &id, 1);
+    switch (kind) {
+    case GlObject::Buffer: glDeleteBuffers(1, &id); break;
+    case GlObject::VertexArray: glDeleteVertexArrays(1, &id); break;
+    case GlObject::Texture: glDeleteTextures(1, &id); break;
+    case GlObject::Shader: glDeleteShader(id); break;
+    case GlObject::Program: glDeleteProgram(id); break;
+    }
+}
+
+unsigned int createGlObject(GlObject kind) {
+    unsigned int id = 0;
+    switch (kind) {
+    case GlObject::Buffer: glGenBuffers(1, &id); break;
+    case GlObject::VertexArray: glGenVertexArrays(1, &id); break;
+    case GlObject::Texture: glGenTextures(1, &id); break;
+    case GlObject::Program: id = glCreateProgram(); break;
+    case GlObject::Shader: assert(("Shaders need a type, use glCreateShader()", false)); break;
+    }
+    return id;
+}
+
+void GlDeletionQueue::setEnabled(bool isEnabled) {
+    if (!isEnabled) {
+        flush();
+    }
+    isQueueEnabled = isEnabled;
+}
+
+bool GlDeletionQueue::isEnabled() {
+    return isQueueEnabled;
+}
+
+std::size_t GlDeletionQueue::getSize() {
+    return queuedBuffers.size() + queuedVertexArrays.size() + queuedTextures.size() +
+           queuedShaders.size() + queuedPrograms.size();
+}
+
+void GlDeletionQueue::flush() {
+    GlState::onDelete(GlObject::VertexArray, queuedVertexArrays.data(), queuedVertexArrays.size());
+    GlState::onDelete(GlObject::Texture, queuedTextures.data(), queuedTextures.size());
+    GlState::onDelete(GlObject::Program, queuedPrograms.data(), queuedPrograms.size());
+
+    if (!queuedBuffers.empty()) {
+        glDeleteBuffers(static_cast<GLsizei>(queuedBuffers.size()), queuedBuffers.data());
+        queuedBuffers.clear();
+    }
+    if (!queuedVertexArrays.empty()) {
+        glDeleteVertexArrays(static_cast<GLsizei>(queuedVertexArrays.size()), queuedVertexArrays.data());
+        queuedVertexArrays.clear();
+    }
+    if (!queuedTextures.empty()) {
+        glDeleteTextures(static_cast<GLsizei>(queuedTextures.size()), queuedTextures.data());
+        queuedTextures.clear();
+    }
+
+    // Shaders and programs have no batched delete
+    for (auto shader : queuedShaders) {
+        glDeleteShader(shader);
+    }
+    queuedShaders.clear();
+    for (auto program : queuedPrograms) {
+        glDeleteProgram(program);
+    }
+    queuedPrograms.clear();
+}
+
+} // namespace lgl
@@ -0,0 +1,154 @@
+#include <lgl/GlState.h>
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace {
+
+// Marks state not known since the last invalidate()
+constexpr unsigned int UNKNOWN = ~0u;
+
+// Units above this are passed to GL unfiltered
+constexpr unsigned int NUM_TRACKED_TEXTURE_UNITS = 32;
+
+enum class Capability {
+    Unknown,
+    Enabled,
+    Disabled
+};
+
+unsigned int currentProgram = UNKNOWN;
+unsigned int currentVertexArray = UNKNOWN;
+unsigned int activeTextureUnit = UNKNOWN;
+std::array<unsigned int, NUM_TRACKED_TEXTURE_UNITS> textures2D = [](){
+    std::array<unsigned int, NUM_TRACKED_TEXTURE_UNITS> textures;
+    textures.fill(UNKNOWN);
+    return textures;
+}();
+std::vector<std::pair<unsigned int, Capability>> capabilities;
+lgl::GlState::Stats stats;
+
+// Sets current to value and returns true if that needs a GL call
+bool update(unsigned int &current, unsigned int value, lgl::GlState::Counts &counts) {
+    if (current == value) {
+        ++counts.numSkippedCalls;
+        return false;
+    }
+    current = value;
+    ++counts.numCalls;
+    return true;
+}
+
+} // namespace
+
+namespace lgl {
+
+void GlState::useProgram(unsigned int program) {
+    if (update(currentProgram, program, stats.programs)) {
+        glUseProgram(program);
+    }
+}
+
+void GlState::bindVertexArray(unsigned int vertexArray) {
+    if (update(currentVertexArray, vertexArray, stats.vertexArrays)) {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void GlState::activeTexture(unsigned int unit) {
+    if (update(activeTextureUnit, unit, stats.textureUnits)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void GlState::bindTexture2D(unsigned int texture) {
+    if (activeTextureUnit >= NUM_TRACKED_TEXTURE_UNITS) {
+        ++stats.textures.numCalls;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        return;
+    }
+
+    if (update(textures2D[activeTextureUnit], texture, stats.textures)) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+    }
+}
+
+void GlState::setEnabled(unsigned int capability, bool isEnabled) {
+    auto entry = std::find_if(capabilities.begin(), capabilities.end(),
+                              [capability](const auto &c){ return c.first == capability; });
+    if (entry == capabilities.end()) {
+        capabilities.emplace_back(capability, Capability::Unknown);
+        entry = capabilities.end() - 1;
+    }
+
+    const auto state = isEnabled ? Capability::Enabled : Capability::Disabled;
+    if (entry->second == state) {
+        ++stats.capabilities.numSkippedCalls;
+        return;
+    }
+    entry->second = state;
+    ++stats.capabilities.numCalls;
+    if (isEnabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+void GlState::invalidate() {
+    currentProgram = UNKNOWN;
+    currentVertexArray = UNKNOWN;
+    activeTextureUnit = UNKNOWN;
+    textures2D.fill(UNKNOWN);
+    for (auto &capability : capabilities) {
+        capability.second = Capability::Unknown;
+    }
+}
+
+void GlState::onDelete(GlObject kind, const unsigned int *ids, std::size_t numIds) {
+    for (auto i = std::size_t(0); i < numIds; ++i) {
+        switch (kind) {
+        case GlObject::VertexArray:
+            if (currentVertexArray == ids[i]) {
+                currentVertexArray = 0;
+            }
+            break;
+        case GlObject::Texture:
+            std::replace(textures2D.begin(), textures2D.end(), ids[i], 0u);
+            break;
+        case GlObject::Program:
+            // Stays in use until another program is, but its name may come back
+            if (currentProgram == ids[i]) {
+                currentProgram = UNKNOWN;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+GlState::Counts GlState::Stats::getTotal() const {
+    Counts total;
+    for (const auto &counts : {this->programs, this->vertexArrays, this->textureUnits, this->textures,
+                               this->capabilities}) {
+        total.numCalls += counts.numCalls;
+        total.numSkippedCalls += counts.numSkippedCalls;
+    }
+    return total;
+}
+
+GlState::Stats GlState::getStats() {
+    return stats;
+}
+
+void GlState::resetStats() {
+    stats = Stats();
+}
+
+} // namespace lgl
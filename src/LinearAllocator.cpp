@@ -0,0 +1,41 @@
+#include <lgl/LinearAllocator.h>
+
+#include <cassert>
+#include <cstdint>
+
+namespace lgl {
+
+LinearAllocator::LinearAllocator(std::size_t blockSize) :
+    blockSize(blockSize) {}
+
+void *LinearAllocator::allocate(std::size_t size, std::size_t alignment) {
+    assert(("Alignment must be a power of two", alignment != 0 && (alignment & (alignment - 1)) == 0));
+    assert(("Allocation larger than a block", size + alignment <= this->blockSize));
+
+    while (true) {
+        if (this->currentBlock < this->blocks.size()) {
+            const auto base = reinterpret_cast<std::uintptr_t>(this->blocks[this->currentBlock].get());
+            const auto aligned = (base + this->offset + alignment - 1) & ~(alignment - 1);
+            if (aligned + size <= base + this->blockSize) {
+                this->offset = aligned + size - base;
+                this->numBytesAllocated += size;
+                return reinterpret_cast<void *>(aligned);
+            }
+
+            // The rest of the block is wasted until the next reset()
+            ++this->currentBlock;
+            this->offset = 0;
+            continue;
+        }
+
+        this->blocks.emplace_back(new unsigned char[this->blockSize]);
+    }
+}
+
+void LinearAllocator::reset() {
+    this->currentBlock = 0;
+    this->offset = 0;
+    this->numBytesAllocated = 0;
+}
+
+} // namespace lgl
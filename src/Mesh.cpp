@@ -1,22 +1,66 @@
 #include <lgl/Mesh.h>
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <utility>
 
 #include <glad/glad.h>
+#include <glm/common.hpp>
 
-#include <lgl/Vertex.h>
+#include <lgl/GeometryPool.h>
+#include <lgl/GlState.h>
 #include <lgl/ShaderProgram.h>
 
 namespace {
 
-void deleteVertexArray(unsigned int *vertexArray) {
-    glDeleteVertexArrays(1, vertexArray);
-    delete vertexArray;
+lgl::Mesh::MeshletStats meshletStats;
+
+void uploadVertices(const std::vector<lgl::Vertex> &vertices, lgl::VertexFormat vertexFormat,
+                    const glm::vec3 &positionScale, const glm::vec3 &positionOffset) {
+    if (vertexFormat == lgl::VertexFormat::Compact) {
+        const auto compactVertices = lgl::compressVertices(vertices, positionScale, positionOffset);
+        glBufferData(GL_ARRAY_BUFFER, compactVertices.size() * sizeof(lgl::CompactVertex),
+                     compactVertices.data(), GL_STATIC_DRAW);
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(lgl::Vertex),
+                     vertices.data(), GL_STATIC_DRAW);
+    }
+    lgl::setVertexAttributes(vertexFormat);
+}
+
+// Points the bound vertex array at both streams of VertexFormat::Split
+void uploadSplitVertices(const std::vector<lgl::Vertex> &vertices,
+                         unsigned int positionBuffer, unsigned int attributeBuffer) {
+    const auto positions = lgl::getPositionStream(vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3),
+                 positions.data(), GL_STATIC_DRAW);
+    lgl::setPositionStreamAttributes();
+
+    const auto attributes = lgl::getAttributeStream(vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, attributeBuffer);
+    glBufferData(GL_ARRAY_BUFFER, attributes.size() * sizeof(lgl::VertexAttributes),
+                 attributes.data(), GL_STATIC_DRAW);
+    lgl::setAttributeStreamAttributes();
 }
 
-void deleteBuffer(unsigned int *buffer) {
-    glDeleteBuffers(1, buffer);
-    delete buffer;
+// Returns the GL index type used
+unsigned int uploadIndices(const std::vector<unsigned int> &indices, std::size_t numVertices) {
+    if (numVertices <= std::numeric_limits<std::uint16_t>::max() + 1u) {
+        const std::vector<std::uint16_t> shortIndices(indices.cbegin(), indices.cend());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     shortIndices.size() * sizeof(std::uint16_t),
+                     shortIndices.data(), GL_STATIC_DRAW);
+        return GL_UNSIGNED_SHORT;
+    }
+
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 indices.size() * sizeof(unsigned int),
+                 indices.data(), GL_STATIC_DRAW);
+    return GL_UNSIGNED_INT;
 }
 
 } // namespace
@@ -26,62 +70,295 @@ namespace lgl {
 Mesh::Mesh(const std::vector<Vertex> &vertices,
            const IndexContainer &indices,
            const std::vector<Texture2D> diffuseTextures,
-           const std::vector<Texture2D> specularTextures) :
-    vao(new unsigned int, deleteVertexArray),
-    vbo(new unsigned int, deleteBuffer),
-    ebo(new unsigned int, deleteBuffer),
-    diffuseTextures(std::move(diffuseTextures)),
-    specularTextures(std::move(specularTextures)),
-    numIndices(indices.size()) {
-
-    glGenVertexArrays(1, this->vao.get());
-    glGenBuffers(1, this->vbo.get());
-    glGenBuffers(1, this->ebo.get());
+           const std::vector<Texture2D> specularTextures,
+           VertexFormat vertexFormat,
+           const std::vector<LodLevel> &coarserLods,
+           const std::vector<Meshlet> &meshlets) :
+    vao(VertexArrayHandle::create()),
+    vbo(BufferHandle::create()),
+    ebo(BufferHandle::create()),
+    meshlets(meshlets),
+    vertexFormat(vertexFormat) {
+
+    this->setTextures(diffuseTextures, specularTextures);
+    this->setPositionBounds(vertices);
 
     // Copy data into GPU
-    glBindVertexArray(*this->vao);
-    glBindBuffer(GL_ARRAY_BUFFER, *this->vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex),
-                 vertices.data(), GL_STATIC_DRAW);
+    GlState::bindVertexArray(this->vao.get());
+    if (this->vertexFormat == VertexFormat::Split) {
+        this->positionVbo = BufferHandle::create();
+        uploadSplitVertices(vertices, this->positionVbo.get(), this->vbo.get());
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, this->vbo.get());
+        uploadVertices(vertices, this->vertexFormat, this->positionScale, this->positionOffset);
+    }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *this->ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                 indices.size() * sizeof(IndexContainer::value_type),
-                 indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo.get());
+    this->indexType = uploadIndices(this->setLods(indices, coarserLods), vertices.size());
 
-    // Positions
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                          reinterpret_cast<void *>(0));
+    if (this->positionVbo) {
+        this->depthVao = VertexArrayHandle::create();
+        GlState::bindVertexArray(this->depthVao.get());
+        glBindBuffer(GL_ARRAY_BUFFER, this->positionVbo.get());
+        setPositionStreamAttributes();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo.get());
+    }
+}
 
-    // Normals
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                          reinterpret_cast<void *>(offsetof(Vertex, normal)));
+Mesh::Mesh(const std::vector<Vertex> &vertices,
+           const IndexContainer &indices,
+           const std::vector<Texture2D> diffuseTextures,
+           const std::vector<Texture2D> specularTextures,
+           GeometryPool *geometryPool,
+           const std::vector<LodLevel> &coarserLods,
+           const std::vector<Meshlet> &meshlets) :
+    meshlets(meshlets),
+    vertexFormat(geometryPool->getVertexFormat()) {
 
-    // Texture coordinates
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                          reinterpret_cast<void *>(offsetof(Vertex, textureCoordinates)));
+    this->setTextures(diffuseTextures, specularTextures);
+    this->setPositionBounds(vertices);
+
+    const auto allIndices = this->setLods(indices, coarserLods);
+    if (this->vertexFormat == VertexFormat::Compact) {
+        const auto compactVertices = compressVertices(vertices, this->positionScale, this->positionOffset);
+        this->geometryAllocation = geometryPool->allocate(compactVertices.data(),
+                                                          compactVertices.size(), allIndices);
+    } else {
+        this->geometryAllocation = geometryPool->allocate(vertices.data(), vertices.size(), allIndices);
+    }
+}
+
+Mesh::IndexContainer Mesh::setLods(const IndexContainer &indices,
+                                  const std::vector<LodLevel> &coarserLods) {
+    // All levels share the vertices, so their indices are packed back to back
+    IndexContainer allIndices = indices;
+    this->lods.push_back({0, indices.size(), 0.0f});
+    for (const auto &lod : coarserLods) {
+        this->lods.push_back({allIndices.size(), lod.indices.size(), lod.error});
+        allIndices.insert(allIndices.cend(), lod.indices.cbegin(), lod.indices.cend());
+    }
+    return allIndices;
+}
+
+void Mesh::setTextures(const std::vector<Texture2D> &diffuseTextures,
+                       const std::vector<Texture2D> &specularTextures) {
+    this->textureSlots.reserve(diffuseTextures.size() + specularTextures.size());
+    for (auto i = 0u; i < diffuseTextures.size(); ++i) {
+        this->textureSlots.push_back({"material.diffuseTexture" + std::to_string(i),
+                                      diffuseTextures[i]});
+    }
+    for (auto i = 0u; i < specularTextures.size(); ++i) {
+        this->textureSlots.push_back({"material.specularTexture" + std::to_string(i),
+                                      specularTextures[i]});
+    }
+
+    for (const auto &slot : this->textureSlots) {
+        this->materialKey = this->materialKey * 31u + slot.texture.getId();
+    }
+}
+
+void Mesh::setPositionBounds(const std::vector<Vertex> &vertices) {
+    for (const auto &v : vertices) {
+        this->bounds = merge(this->bounds, v.position);
+    }
+
+    if (this->vertexFormat != VertexFormat::Compact || vertices.empty()) {
+        return;
+    }
+    this->positionOffset = this->bounds.min;
+    this->positionScale = this->bounds.max - this->bounds.min;
+}
+
+void Mesh::selectLod(float errorScale, float maxError) {
+    this->currentLod = lgl::selectLod(this->lods.size(), this->currentLod, maxError,
+                                      [this, errorScale](std::size_t lod){ return this->lods[lod].error * errorScale; });
 }
 
 void Mesh::render(ShaderProgram *shaderProgram) {
-    auto textureUnit = 0;
+    this->bindMaterial(shaderProgram);
+    this->draw(shaderProgram);
+}
+
+void Mesh::draw(ShaderProgram *shaderProgram) {
+    this->setVertexUniforms(shaderProgram);
+    this->draw();
+}
+
+void Mesh::draw() {
+    const auto &lod = this->lods[this->currentLod];
+    this->drawFirstIndices.assign(1, lod.firstIndex);
+    this->drawCounts.assign(1, static_cast<int>(lod.numIndices));
+    this->drawRanges();
+}
+
+DrawUniformBlock Mesh::getDrawUniformBlock(const glm::mat4 &model, const glm::mat3 &normal) const {
+    return DrawUniformBlock(model, normal, this->positionScale, this->positionOffset, this->shine);
+}
+
+bool Mesh::hasSameMaterial(const Mesh &other) const {
+    return this->textureSlots.size() == other.textureSlots.size() &&
+           std::equal(this->textureSlots.cbegin(), this->textureSlots.cend(), other.textureSlots.cbegin(),
+                      [](const auto &a, const auto &b){
+                          return a.texture.getId() == b.texture.getId() && a.samplerName == b.samplerName;
+                      });
+}
 
-    for (auto i = 0u; i < this->diffuseTextures.size(); ++i, ++textureUnit) {
-        glActiveTexture(GL_TEXTURE0 + textureUnit);
-        shaderProgram->setUniform("material.diffuseTexture" + std::to_string(i), textureUnit);
-        this->diffuseTextures[i].bind();
+unsigned int Mesh::getVertexArray() const {
+    if (this->geometryAllocation) {
+        return this->geometryAllocation.get_deleter().geometryPool->getVertexArray();
     }
+    return this->vao.get();
+}
+
+GeometryPool *Mesh::getGeometryPool() const {
+    return this->geometryAllocation ? this->geometryAllocation.get_deleter().geometryPool : nullptr;
+}
+
+GeometryPool::DrawCommand Mesh::getDrawCommand() const {
+    assert(("Only meshes in a geometry pool draw indirectly", this->geometryAllocation));
+
+    const auto &lod = this->lods[this->currentLod];
+    return this->getGeometryPool()->getDrawCommand(*this->geometryAllocation, lod.firstIndex, lod.numIndices);
+}
+
+void Mesh::render(ShaderProgram *shaderProgram, const Frustum &frustum, const glm::vec3 &cameraPosition) {
+    if (this->currentLod != 0 || this->meshlets.empty()) {
+        this->render(shaderProgram);
+        return;
+    }
+
+    // Gather the surviving meshlets, merging neighbors into one range
+    this->drawFirstIndices.clear();
+    this->drawCounts.clear();
+    for (const auto &meshlet : this->meshlets) {
+        ++meshletStats.numMeshlets;
+        if (!frustum.intersectsSphere(meshlet.center, meshlet.radius)) {
+            ++meshletStats.numFrustumCulled;
+            continue;
+        }
+        if (isBackfacing(meshlet, cameraPosition)) {
+            ++meshletStats.numBackfaceCulled;
+            continue;
+        }
+
+        if (!this->drawCounts.empty() &&
+                this->drawFirstIndices.back() + this->drawCounts.back() == meshlet.firstIndex) {
+            this->drawCounts.back() += static_cast<int>(meshlet.numIndices);
+        } else {
+            this->drawFirstIndices.push_back(meshlet.firstIndex);
+            this->drawCounts.push_back(static_cast<int>(meshlet.numIndices));
+        }
+    }
+
+    if (this->drawCounts.empty()) {
+        return;
+    }
+
+    this->bindMaterial(shaderProgram);
+    this->setVertexUniforms(shaderProgram);
+    this->drawRanges();
+}
+
+void Mesh::renderDepth(ShaderProgram *shaderProgram) {
+    this->setVertexUniforms(shaderProgram);
+
+    const auto &lod = this->lods[this->currentLod];
+    this->drawFirstIndices.assign(1, lod.firstIndex);
+    this->drawCounts.assign(1, static_cast<int>(lod.numIndices));
+    this->drawRanges(true);
+}
+
+void Mesh::renderInstanced(ShaderProgram *shaderProgram, unsigned int instanceBuffer, std::size_t numInstances) {
+    const auto &lod = this->lods[this->currentLod];
+    this->bindMaterial(shaderProgram);
+    this->setVertexUniforms(shaderProgram);
+
+    if (this->geometryAllocation) {
+        this->geometryAllocation.get_deleter().geometryPool->drawInstanced(*this->geometryAllocation,
+                                                                           lod.firstIndex, lod.numIndices,
+                                                                           instanceBuffer, numInstances);
+        return;
+    }
+
+    GlState::bindVertexArray(this->vao.get());
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    setInstanceAttributes();
+
+    const auto indexSize = this->indexType == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(unsigned int);
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(lod.numIndices), this->indexType,
+                            reinterpret_cast<void *>(lod.firstIndex * indexSize),
+                            static_cast<GLsizei>(numInstances));
+
+    // Non-instanced draws of this mesh must not read the instance buffer
+    disableInstanceAttributes();
+}
+
+Mesh::MeshletStats Mesh::getMeshletStats() {
+    return meshletStats;
+}
+
+void Mesh::resetMeshletStats() {
+    meshletStats = MeshletStats();
+}
+
+void Mesh::bindMaterial(ShaderProgram *shaderProgram) {
+    const auto &textureUnits = this->getTextureUnits(*shaderProgram);
+    for (auto i = 0u; i < this->textureSlots.size(); ++i) {
+        if (textureUnits[i] < 0) {
+            continue; // Not sampled by this shader program
+        }
+
+        GlState::activeTexture(textureUnits[i]);
+        this->textureSlots[i].texture.bind();
+    }
+}
+
+const std::vector<int> &Mesh::getTextureUnits(const ShaderProgram &shaderProgram) {
+    // Meshes are drawn with one or two programs, so a linear search wins
+    const auto programId = shaderProgram.getId();
+    const auto cached = std::find_if(this->slotTextureUnits.cbegin(), this->slotTextureUnits.cend(),
+                                     [programId](const auto &units){ return units.program == programId; });
+    if (cached != this->slotTextureUnits.cend()) {
+        return cached->textureUnits;
+    }
+
+    SlotTextureUnits units{programId, {}};
+    units.textureUnits.reserve(this->textureSlots.size());
+    for (const auto &slot : this->textureSlots) {
+        units.textureUnits.push_back(shaderProgram.getTextureUnit(slot.samplerName));
+    }
+    this->slotTextureUnits.push_back(std::move(units));
+    return this->slotTextureUnits.back().textureUnits;
+}
+
+void Mesh::setVertexUniforms(ShaderProgram *shaderProgram) {
+    if (this->vertexFormat == VertexFormat::Compact) {
+        shaderProgram->setUniform("positionScale", this->positionScale);
+        shaderProgram->setUniform("positionOffset", this->positionOffset);
+    }
+}
+
+void Mesh::drawRanges(bool positionsOnly) {
+    if (this->geometryAllocation) {
+        this->geometryAllocation.get_deleter().geometryPool->draw(*this->geometryAllocation,
+                                                                  this->drawFirstIndices, this->drawCounts);
+        return;
+    }
+
+    GlState::bindVertexArray(positionsOnly && this->depthVao ? this->depthVao.get() : this->vao.get());
 
-    for (auto i = 0u; i < this->specularTextures.size(); ++i, ++textureUnit) {
-        glActiveTexture(GL_TEXTURE0 + textureUnit);
-        shaderProgram->setUniform("material.specularTexture" + std::to_string(i), textureUnit);
-        this->specularTextures[i].bind();
+    const auto indexSize = this->indexType == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(unsigned int);
+    if (this->drawCounts.size() == 1) {
+        glDrawElements(GL_TRIANGLES, this->drawCounts.front(), this->indexType,
+                       reinterpret_cast<void *>(this->drawFirstIndices.front() * indexSize));
+        return;
     }
 
-    glBindVertexArray(*this->vao);
-    glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, 0);
+    this->drawOffsets.clear();
+    std::transform(this->drawFirstIndices.cbegin(), this->drawFirstIndices.cend(), std::back_inserter(this->drawOffsets),
+                   [indexSize](const auto firstIndex){ return reinterpret_cast<const void *>(firstIndex * indexSize); });
+    glMultiDrawElements(GL_TRIANGLES, this->drawCounts.data(), this->indexType,
+                        this->drawOffsets.data(), static_cast<GLsizei>(this->drawCounts.size()));
 }
 
 } // namespace lgl
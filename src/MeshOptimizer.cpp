@@ -0,0 +1,412 @@
+#include <lgl/MeshOptimizer.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+
+#include <lgl/Vertex.h>
+
+namespace {
+
+constexpr auto NO_VERTEX = std::numeric_limits<unsigned int>::max();
+
+using VertexKey = std::array<std::uint32_t, 8>;
+
+std::uint32_t toKeyComponent(float value, float epsilon) {
+    if (epsilon > 0.0f) {
+        return static_cast<std::uint32_t>(static_cast<std::int32_t>(std::floor(value / epsilon + 0.5f)));
+    }
+
+    // Compare bit patterns, treating -0.0 and 0.0 as the same value
+    std::uint32_t bits = 0u;
+    if (value != 0.0f) {
+        std::memcpy(&bits, &value, sizeof(bits));
+    }
+    return bits;
+}
+
+VertexKey toVertexKey(const lgl::Vertex &vertex, float epsilon) {
+    return {toKeyComponent(vertex.position.x, epsilon),
+            toKeyComponent(vertex.position.y, epsilon),
+            toKeyComponent(vertex.position.z, epsilon),
+            toKeyComponent(vertex.normal.x, epsilon),
+            toKeyComponent(vertex.normal.y, epsilon),
+            toKeyComponent(vertex.normal.z, epsilon),
+            toKeyComponent(vertex.textureCoordinates.x, epsilon),
+            toKeyComponent(vertex.textureCoordinates.y, epsilon)};
+}
+
+// MurmurHash3 mixing of each key component
+std::uint32_t hashVertexKey(const VertexKey &key) {
+    std::uint32_t hash = 0u;
+    for (auto k : key) {
+        k *= 0xcc9e2d51u;
+        k = (k << 15) | (k >> 17);
+        k *= 0x1b873593u;
+        hash ^= k;
+        hash = (hash << 13) | (hash >> 19);
+        hash = hash * 5u + 0xe6546b64u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+// FIFO post-transform vertex cache where a vertex is resident while fewer than
+// cacheSize misses have happened since it was last transformed
+class VertexCache {
+public:
+    VertexCache(std::size_t numVertices, unsigned int cacheSize) :
+        timestamps(numVertices, 0u), time(cacheSize + 1), cacheSize(cacheSize) {}
+
+    bool contains(unsigned int vertex) const {
+        return this->time - this->timestamps[vertex] <= this->cacheSize;
+    }
+
+    unsigned int age(unsigned int vertex) const {
+        return this->time - this->timestamps[vertex];
+    }
+
+    // Returns the number of cache misses
+    unsigned int access(unsigned int vertex) {
+        if (this->contains(vertex)) {
+            return 0u;
+        }
+        this->timestamps[vertex] = this->time++;
+        return 1u;
+    }
+
+    unsigned int accessTriangle(const unsigned int *triangle) {
+        return this->access(triangle[0]) + this->access(triangle[1]) + this->access(triangle[2]);
+    }
+
+    void flush() {
+        this->time += this->cacheSize + 1;
+    }
+
+private:
+    std::vector<unsigned int> timestamps;
+    unsigned int time;
+    unsigned int cacheSize;
+};
+
+// Splits the triangle list where a triangle misses the cache on all of its
+// vertices, which usually marks the start of a disjoint patch of the mesh
+std::vector<std::size_t> findHardBoundaries(const std::vector<unsigned int> &indices,
+                                            std::size_t numVertices, unsigned int cacheSize) {
+    std::vector<std::size_t> boundaries;
+    VertexCache cache(numVertices, cacheSize);
+    for (auto t = 0u; t < indices.size() / 3; ++t) {
+        if (cache.accessTriangle(&indices[3 * t]) == 3 || t == 0) {
+            boundaries.push_back(t);
+        }
+    }
+    boundaries.push_back(indices.size() / 3);
+    return boundaries;
+}
+
+// Further splits each hard cluster once the running ACMR of the current
+// cluster is within threshold of the ACMR of the whole hard cluster
+std::vector<std::size_t> findSoftBoundaries(const std::vector<unsigned int> &indices,
+                                            const std::vector<std::size_t> &hardBoundaries,
+                                            std::size_t numVertices, unsigned int cacheSize,
+                                            float threshold) {
+    std::vector<std::size_t> boundaries;
+    VertexCache cache(numVertices, cacheSize);
+
+    for (auto c = 0u; c + 1 < hardBoundaries.size(); ++c) {
+        const auto start = hardBoundaries[c];
+        const auto end = hardBoundaries[c + 1];
+
+        cache.flush();
+        auto numClusterMisses = 0u;
+        for (auto t = start; t < end; ++t) {
+            numClusterMisses += cache.accessTriangle(&indices[3 * t]);
+        }
+        const auto clusterThreshold = threshold * numClusterMisses / (end - start);
+
+        cache.flush();
+        boundaries.push_back(start);
+        auto numMisses = 0u;
+        auto numTriangles = 0u;
+        for (auto t = start; t < end; ++t) {
+            numMisses += cache.accessTriangle(&indices[3 * t]);
+            ++numTriangles;
+
+            if (static_cast<float>(numMisses) / numTriangles <= clusterThreshold && t + 1 < end) {
+                boundaries.push_back(t + 1);
+                cache.flush();
+                numMisses = 0u;
+                numTriangles = 0u;
+            }
+        }
+
+        // The remainder never reached the threshold, so keep it with the
+        // cluster before it rather than paying its misses on its own
+        if (numTriangles > 0 && boundaries.back() != start &&
+                static_cast<float>(numMisses) / numTriangles > clusterThreshold) {
+            boundaries.pop_back();
+        }
+    }
+
+    boundaries.push_back(indices.size() / 3);
+    return boundaries;
+}
+
+} // namespace
+
+namespace lgl {
+
+std::size_t weldVertices(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices,
+                         float epsilon) {
+    // Open addressing table with linear probing, kept at most half full
+    auto tableSize = std::size_t(1);
+    while (tableSize < 2 * vertices.size()) {
+        tableSize *= 2;
+    }
+    const auto tableMask = tableSize - 1;
+    std::vector<unsigned int> table(tableSize, NO_VERTEX);
+
+    std::vector<VertexKey> uniqueKeys;
+    uniqueKeys.reserve(vertices.size());
+    std::vector<unsigned int> remap(vertices.size());
+    auto numUniqueVertices = 0u;
+
+    for (auto i = 0u; i < vertices.size(); ++i) {
+        const auto key = toVertexKey(vertices[i], epsilon);
+        auto slot = hashVertexKey(key) & tableMask;
+        while (table[slot] != NO_VERTEX && uniqueKeys[table[slot]] != key) {
+            slot = (slot + 1) & tableMask;
+        }
+
+        if (table[slot] == NO_VERTEX) {
+            table[slot] = numUniqueVertices;
+            uniqueKeys.push_back(key);
+            vertices[numUniqueVertices++] = vertices[i];
+        }
+        remap[i] = table[slot];
+    }
+
+    for (auto &i : indices) {
+        i = remap[i];
+    }
+
+    const auto numWeldedVertices = vertices.size() - numUniqueVertices;
+    vertices.erase(vertices.begin() + numUniqueVertices, vertices.end());
+    vertices.shrink_to_fit();
+    return numWeldedVertices;
+}
+
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int> &indices,
+                                    std::size_t numVertices,
+                                    unsigned int cacheSize) {
+    VertexCacheStats stats;
+    stats.numTriangles = indices.size() / 3;
+
+    std::vector<bool> isReferenced(numVertices, false);
+    for (const auto i : indices) {
+        if (!isReferenced[i]) {
+            isReferenced[i] = true;
+            ++stats.numVertices;
+        }
+    }
+
+    VertexCache cache(numVertices, cacheSize);
+    for (auto t = 0u; t < stats.numTriangles; ++t) {
+        stats.numTransformedVertices += cache.accessTriangle(&indices[3 * t]);
+    }
+
+    return stats;
+}
+
+std::vector<unsigned int> optimizeVertexCache(const std::vector<unsigned int> &indices,
+                                              std::size_t numVertices,
+                                              unsigned int cacheSize) {
+    const auto numTriangles = indices.size() / 3;
+
+    // Build vertex -> triangle adjacency
+    std::vector<unsigned int> numLiveTriangles(numVertices, 0u);
+    for (auto i = 0u; i < 3 * numTriangles; ++i) {
+        ++numLiveTriangles[indices[i]];
+    }
+
+    std::vector<unsigned int> adjacencyOffsets(numVertices + 1, 0u);
+    std::partial_sum(numLiveTriangles.cbegin(), numLiveTriangles.cend(),
+                     adjacencyOffsets.begin() + 1);
+
+    std::vector<unsigned int> adjacency(3 * numTriangles);
+    auto adjacencyCursors = adjacencyOffsets;
+    for (auto i = 0u; i < 3 * numTriangles; ++i) {
+        adjacency[adjacencyCursors[indices[i]]++] = i / 3;
+    }
+
+    // Tipsify: fan around the current vertex, then continue from the candidate
+    // that will still be in the cache, falling back to recently used vertices
+    VertexCache cache(numVertices, cacheSize);
+    std::vector<bool> isEmitted(numTriangles, false);
+    std::vector<unsigned int> deadEnds;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> optimizedIndices;
+    optimizedIndices.reserve(3 * numTriangles);
+
+    auto cursor = 0u;
+    auto fanningVertex = numTriangles > 0 ? 0u : NO_VERTEX;
+    while (fanningVertex != NO_VERTEX) {
+        candidates.clear();
+        for (auto a = adjacencyOffsets[fanningVertex]; a < adjacencyOffsets[fanningVertex + 1]; ++a) {
+            const auto t = adjacency[a];
+            if (isEmitted[t]) {
+                continue;
+            }
+
+            for (auto i = 3 * t; i < 3 * t + 3; ++i) {
+                const auto v = indices[i];
+                optimizedIndices.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                --numLiveTriangles[v];
+                cache.access(v);
+            }
+            isEmitted[t] = true;
+        }
+
+        // Pick the candidate with live triangles that stays in the cache the longest
+        fanningVertex = NO_VERTEX;
+        auto bestPriority = -1;
+        for (const auto v : candidates) {
+            if (numLiveTriangles[v] == 0) {
+                continue;
+            }
+
+            auto priority = 0;
+            if (cache.age(v) + 2 * numLiveTriangles[v] <= cacheSize) {
+                priority = static_cast<int>(cache.age(v));
+            }
+
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                fanningVertex = v;
+            }
+        }
+
+        // Dead end: back track through recently emitted vertices, then scan
+        while (fanningVertex == NO_VERTEX && !deadEnds.empty()) {
+            const auto v = deadEnds.back();
+            deadEnds.pop_back();
+            if (numLiveTriangles[v] > 0) {
+                fanningVertex = v;
+            }
+        }
+
+        while (fanningVertex == NO_VERTEX && cursor < numVertices) {
+            if (numLiveTriangles[cursor] > 0) {
+                fanningVertex = cursor;
+            }
+            ++cursor;
+        }
+    }
+
+    return optimizedIndices;
+}
+
+std::vector<unsigned int> optimizeOverdraw(const std::vector<unsigned int> &indices,
+                                           const std::vector<Vertex> &vertices,
+                                           float threshold,
+                                           unsigned int cacheSize) {
+    const auto hardBoundaries = findHardBoundaries(indices, vertices.size(), cacheSize);
+    const auto boundaries = findSoftBoundaries(indices, hardBoundaries, vertices.size(),
+                                               cacheSize, threshold);
+    const auto numClusters = boundaries.size() - 1;
+
+    glm::vec3 meshCentroid(0.0f);
+    for (const auto i : indices) {
+        meshCentroid += vertices[i].position;
+    }
+    if (!indices.empty()) {
+        meshCentroid /= static_cast<float>(indices.size());
+    }
+
+    // Sort clusters so those facing away from the mesh center are drawn first
+    std::vector<float> sortKeys(numClusters);
+    for (auto c = 0u; c < numClusters; ++c) {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        auto area = 0.0f;
+
+        for (auto t = boundaries[c]; t < boundaries[c + 1]; ++t) {
+            const auto &p0 = vertices[indices[3 * t]].position;
+            const auto &p1 = vertices[indices[3 * t + 1]].position;
+            const auto &p2 = vertices[indices[3 * t + 2]].position;
+
+            const auto areaNormal = glm::cross(p1 - p0, p2 - p0);
+            const auto triangleArea = glm::length(areaNormal);
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += areaNormal;
+            area += triangleArea;
+        }
+
+        if (area > 0.0f) {
+            centroid /= area;
+        }
+        const auto normalLength = glm::length(normal);
+        if (normalLength > 0.0f) {
+            normal /= normalLength;
+        }
+
+        sortKeys[c] = glm::dot(centroid - meshCentroid, normal);
+    }
+
+    std::vector<std::size_t> clusterOrder(numClusters);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0u);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+                     [&sortKeys](const auto a, const auto b){ return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<unsigned int> optimizedIndices;
+    optimizedIndices.reserve(indices.size());
+    for (const auto c : clusterOrder) {
+        optimizedIndices.insert(optimizedIndices.cend(),
+                                indices.cbegin() + 3 * boundaries[c],
+                                indices.cbegin() + 3 * boundaries[c + 1]);
+    }
+    return optimizedIndices;
+}
+
+void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+    std::vector<unsigned int> remap(vertices.size(), NO_VERTEX);
+    std::vector<Vertex> optimizedVertices;
+    optimizedVertices.reserve(vertices.size());
+
+    for (auto &i : indices) {
+        if (remap[i] == NO_VERTEX) {
+            remap[i] = static_cast<unsigned int>(optimizedVertices.size());
+            optimizedVertices.push_back(vertices[i]);
+        }
+        i = remap[i];
+    }
+
+    vertices.swap(optimizedVertices);
+}
+
+MeshOptimizationStats optimizeMesh(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+    MeshOptimizationStats stats;
+    stats.before = analyzeVertexCache(indices, vertices.size());
+
+    indices = optimizeVertexCache(indices, vertices.size());
+    indices = optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(vertices, indices);
+
+    stats.after = analyzeVertexCache(indices, vertices.size());
+    return stats;
+}
+
+} // namespace lgl
@@ -0,0 +1,310 @@
+#include <lgl/MeshSimplifier.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+
+#include <lgl/Vertex.h>
+
+namespace {
+
+// Stop generating LODs once a level keeps more than this fraction of the
+// triangles of the previous one
+constexpr float MIN_LOD_REDUCTION = 0.9f;
+
+// Symmetric 4x4 matrix summing squared distances to a set of planes,
+// weighted by triangle area
+struct Quadric {
+    double a2 = 0.0, b2 = 0.0, c2 = 0.0, d2 = 0.0;
+    double ab = 0.0, ac = 0.0, ad = 0.0;
+    double bc = 0.0, bd = 0.0, cd = 0.0;
+    double weight = 0.0;
+
+    Quadric() = default;
+
+    Quadric(const glm::dvec3 &normal, double distance, double weight) :
+        a2(weight * normal.x * normal.x), b2(weight * normal.y * normal.y),
+        c2(weight * normal.z * normal.z), d2(weight * distance * distance),
+        ab(weight * normal.x * normal.y), ac(weight * normal.x * normal.z),
+        ad(weight * normal.x * distance), bc(weight * normal.y * normal.z),
+        bd(weight * normal.y * distance), cd(weight * normal.z * distance),
+        weight(weight) {}
+
+    Quadric &operator+=(const Quadric &other) {
+        this->a2 += other.a2; this->b2 += other.b2; this->c2 += other.c2; this->d2 += other.d2;
+        this->ab += other.ab; this->ac += other.ac; this->ad += other.ad;
+        this->bc += other.bc; this->bd += other.bd; this->cd += other.cd;
+        this->weight += other.weight;
+        return *this;
+    }
+
+    // Mean squared distance of position to the planes
+    double error(const glm::dvec3 &p) const {
+        if (this->weight <= 0.0) {
+            return 0.0;
+        }
+        const auto e = this->a2 * p.x * p.x + this->b2 * p.y * p.y + this->c2 * p.z * p.z +
+                       2.0 * (this->ab * p.x * p.y + this->ac * p.x * p.z + this->bc * p.y * p.z) +
+                       2.0 * (this->ad * p.x + this->bd * p.y + this->cd * p.z) +
+                       this->d2;
+        return std::max(e, 0.0) / this->weight;
+    }
+};
+
+struct Collapse {
+    unsigned int from;
+    unsigned int to;
+    double error;
+};
+
+std::uint64_t toEdgeKey(unsigned int a, unsigned int b) {
+    return (static_cast<std::uint64_t>(a) << 32) | b;
+}
+
+// Maps every vertex to the first vertex sharing its position
+std::vector<unsigned int> findPositionRemap(const std::vector<lgl::Vertex> &vertices) {
+    struct PositionHash {
+        std::size_t operator()(const glm::vec3 &p) const {
+            const std::hash<float> hash;
+            return hash(p.x) ^ (hash(p.y) * 31u) ^ (hash(p.z) * 997u);
+        }
+    };
+
+    std::unordered_map<glm::vec3, unsigned int, PositionHash> firstVertices;
+    firstVertices.reserve(vertices.size());
+
+    std::vector<unsigned int> remap(vertices.size());
+    for (auto i = 0u; i < vertices.size(); ++i) {
+        remap[i] = firstVertices.emplace(vertices[i].position, i).first->second;
+    }
+    return remap;
+}
+
+// Vertices on open borders or attribute seams are locked in place, since
+// moving them would open cracks or smear attributes
+std::vector<bool> findLockedVertices(const std::vector<unsigned int> &indices,
+                                     const std::vector<unsigned int> &positionRemap) {
+    std::vector<bool> isLocked(positionRemap.size(), false);
+
+    std::vector<unsigned int> numVerticesAtPosition(positionRemap.size(), 0u);
+    for (auto i = 0u; i < positionRemap.size(); ++i) {
+        ++numVerticesAtPosition[positionRemap[i]];
+    }
+    for (auto i = 0u; i < positionRemap.size(); ++i) {
+        if (numVerticesAtPosition[positionRemap[i]] > 1) {
+            isLocked[i] = true;
+        }
+    }
+
+    std::unordered_set<std::uint64_t> edges;
+    edges.reserve(indices.size());
+    for (std::size_t i = 0; i < indices.size(); i += 3) {
+        for (auto k = 0u; k < 3; ++k) {
+            edges.insert(toEdgeKey(positionRemap[indices[i + k]], positionRemap[indices[i + (k + 1) % 3]]));
+        }
+    }
+    for (std::size_t i = 0; i < indices.size(); i += 3) {
+        for (auto k = 0u; k < 3; ++k) {
+            const auto a = indices[i + k];
+            const auto b = indices[i + (k + 1) % 3];
+            if (edges.count(toEdgeKey(positionRemap[b], positionRemap[a])) == 0) {
+                isLocked[a] = true;
+                isLocked[b] = true;
+            }
+        }
+    }
+    return isLocked;
+}
+
+// Moving from onto to must not turn any remaining triangle around from inside out
+bool flipsTriangles(const Collapse &collapse,
+                    const std::vector<lgl::Vertex> &vertices,
+                    const std::vector<unsigned int> &indices,
+                    const std::vector<unsigned int> &triangles) {
+    const auto &target = vertices[collapse.to].position;
+    for (auto triangle : triangles) {
+        const auto *corners = &indices[3 * triangle];
+        if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to) {
+            continue;
+        }
+
+        const auto k = corners[0] == collapse.from ? 0u : corners[1] == collapse.from ? 1u : 2u;
+        const auto &p1 = vertices[corners[(k + 1) % 3]].position;
+        const auto &p2 = vertices[corners[(k + 2) % 3]].position;
+        const auto before = glm::cross(p1 - vertices[collapse.from].position, p2 - vertices[collapse.from].position);
+        const auto after = glm::cross(p1 - target, p2 - target);
+        if (glm::dot(before, after) <= 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+namespace lgl {
+
+std::vector<unsigned int> simplifyMesh(const std::vector<Vertex> &vertices,
+                                       const std::vector<unsigned int> &indices,
+                                       std::size_t targetNumIndices,
+                                       float *error) {
+    auto result = indices;
+    double maxError = 0.0;
+
+    const auto positionRemap = findPositionRemap(vertices);
+    const auto isLocked = findLockedVertices(indices, positionRemap);
+
+    // Plane quadrics of the triangles around each vertex, shared by all
+    // vertices at the same position
+    std::vector<Quadric> quadrics(vertices.size());
+    for (std::size_t i = 0; i < indices.size(); i += 3) {
+        const glm::dvec3 p0 = vertices[indices[i]].position;
+        const glm::dvec3 p1 = vertices[indices[i + 1]].position;
+        const glm::dvec3 p2 = vertices[indices[i + 2]].position;
+        const auto normal = glm::cross(p1 - p0, p2 - p0);
+        const auto length = glm::length(normal);
+        if (length == 0.0) {
+            continue;
+        }
+
+        const Quadric quadric(normal / length, -glm::dot(normal / length, p0), 0.5 * length);
+        for (auto k = 0u; k < 3; ++k) {
+            quadrics[positionRemap[indices[i + k]]] += quadric;
+        }
+    }
+    for (auto i = 0u; i < vertices.size(); ++i) {
+        quadrics[i] = quadrics[positionRemap[i]];
+    }
+
+    std::vector<Collapse> collapses;
+    std::vector<unsigned int> remap(vertices.size());
+    std::vector<bool> isCollapseLocked(vertices.size());
+    std::vector<unsigned int> firstTriangles(vertices.size() + 1);
+    std::vector<unsigned int> vertexTriangles;
+
+    while (result.size() > targetNumIndices) {
+        // Triangles around each vertex in compressed row storage
+        std::fill(firstTriangles.begin(), firstTriangles.end(), 0u);
+        for (auto index : result) {
+            ++firstTriangles[index + 1];
+        }
+        std::partial_sum(firstTriangles.begin(), firstTriangles.end(), firstTriangles.begin());
+        vertexTriangles.resize(result.size());
+        auto nextTriangles = firstTriangles;
+        for (std::size_t i = 0; i < result.size(); ++i) {
+            vertexTriangles[nextTriangles[result[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+
+        // Rank every collapse of an unlocked vertex along one of its edges
+        collapses.clear();
+        for (std::size_t i = 0; i < result.size(); i += 3) {
+            for (auto k = 0u; k < 3; ++k) {
+                const auto from = result[i + k];
+                const auto to = result[i + (k + 1) % 3];
+                if (isLocked[from]) {
+                    continue;
+                }
+
+                auto quadric = quadrics[from];
+                quadric += quadrics[to];
+                collapses.push_back({from, to, quadric.error(vertices[to].position)});
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const auto &a, const auto &b){ return a.error < b.error; });
+
+        // Collapse the cheapest edges first. A collapse locks the one-ring of
+        // its vertex, so every flip test this pass sees up to date triangles.
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::fill(isCollapseLocked.begin(), isCollapseLocked.end(), false);
+        auto numTriangles = result.size() / 3;
+        const auto targetNumTriangles = targetNumIndices / 3;
+        for (const auto &collapse : collapses) {
+            if (numTriangles <= targetNumTriangles) {
+                break;
+            }
+            if (isCollapseLocked[collapse.from] || isCollapseLocked[collapse.to]) {
+                continue;
+            }
+
+            const std::vector<unsigned int> triangles(vertexTriangles.begin() + firstTriangles[collapse.from],
+                                                      vertexTriangles.begin() + firstTriangles[collapse.from + 1]);
+            if (flipsTriangles(collapse, vertices, result, triangles)) {
+                continue;
+            }
+
+            for (auto triangle : triangles) {
+                for (auto k = 0u; k < 3; ++k) {
+                    const auto corner = result[3 * triangle + k];
+                    isCollapseLocked[corner] = true;
+                    if (corner == collapse.to) {
+                        --numTriangles;
+                    }
+                }
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            maxError = std::max(maxError, collapse.error);
+        }
+
+        // Apply the collapses and drop the triangles that became degenerate
+        const auto numIndices = result.size();
+        std::size_t numKept = 0;
+        for (std::size_t i = 0; i < numIndices; i += 3) {
+            const auto a = remap[result[i]];
+            const auto b = remap[result[i + 1]];
+            const auto c = remap[result[i + 2]];
+            if (a != b && b != c && c != a) {
+                result[numKept++] = a;
+                result[numKept++] = b;
+                result[numKept++] = c;
+            }
+        }
+        result.resize(numKept);
+
+        if (numKept == numIndices) {
+            break;
+        }
+    }
+
+    if (error) {
+        *error = static_cast<float>(std::sqrt(maxError));
+    }
+    return result;
+}
+
+std::vector<LodLevel> generateLods(const std::vector<Vertex> &vertices,
+                                   const std::vector<unsigned int> &indices,
+                                   const LodSettings &settings) {
+    std::vector<LodLevel> lods;
+
+    // Each level is simplified from the full detail mesh, so its error is
+    // measured against the original surface rather than accumulated
+    auto targetNumTriangles = static_cast<float>(indices.size() / 3);
+    auto previousNumIndices = indices.size();
+    for (auto i = 1u; i < settings.maxNumLods; ++i) {
+        targetNumTriangles *= settings.triangleRatio;
+
+        LodLevel lod;
+        lod.indices = simplifyMesh(vertices, indices, 3 * static_cast<std::size_t>(targetNumTriangles), &lod.error);
+        if (lod.indices.empty() || lod.indices.size() > MIN_LOD_REDUCTION * previousNumIndices) {
+            break;
+        }
+
+        if (!lods.empty()) {
+            lod.error = std::max(lod.error, lods.back().error);
+        }
+        previousNumIndices = lod.indices.size();
+        lods.push_back(std::move(lod));
+    }
+    return lods;
+}
+
+} // namespace lgl
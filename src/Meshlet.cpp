@@ -0,0 +1,134 @@
+#include <lgl/Meshlet.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <lgl/Vertex.h>
+
+namespace {
+
+// Once a meshlet holds this fraction of its maximum triangles, a triangle
+// more than acos(MAX_MESHLET_NORMAL_COS) off its average normal starts a new one
+constexpr float MIN_MESHLET_FILL = 0.25f;
+constexpr float MAX_MESHLET_NORMAL_COS = 0.5f;
+
+// Unit normal, or zero for degenerate triangles
+glm::vec3 getTriangleNormal(const std::vector<lgl::Vertex> &vertices, const unsigned int *triangle) {
+    const auto &p0 = vertices[triangle[0]].position;
+    const auto normal = glm::cross(vertices[triangle[1]].position - p0, vertices[triangle[2]].position - p0);
+    const auto length = glm::length(normal);
+    return length > 0.0f ? normal / length : glm::vec3(0.0f);
+}
+
+void setBounds(lgl::Meshlet &meshlet,
+               const std::vector<lgl::Vertex> &vertices,
+               const std::vector<unsigned int> &indices) {
+    const auto begin = indices.cbegin() + meshlet.firstIndex;
+    const auto end = begin + meshlet.numIndices;
+
+    // Sphere around the center of the bounding box
+    auto minPosition = glm::vec3(std::numeric_limits<float>::max());
+    auto maxPosition = glm::vec3(std::numeric_limits<float>::lowest());
+    std::for_each(begin, end, [&](const auto i){
+        minPosition = glm::min(minPosition, vertices[i].position);
+        maxPosition = glm::max(maxPosition, vertices[i].position);
+    });
+    meshlet.center = 0.5f * (minPosition + maxPosition);
+    meshlet.radius = 0.0f;
+    std::for_each(begin, end, [&](const auto i){
+        meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, vertices[i].position));
+    });
+
+    // Cone around the average triangle normal
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.numIndices / 3);
+    for (auto i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.numIndices; i += 3) {
+        const auto normal = getTriangleNormal(vertices, &indices[i]);
+        if (normal != glm::vec3(0.0f)) {
+            normals.push_back(normal);
+        }
+    }
+
+    auto axis = glm::vec3(0.0f);
+    for (const auto &normal : normals) {
+        axis += normal;
+    }
+    const auto axisLength = glm::length(axis);
+    meshlet.coneAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+
+    auto minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+    for (const auto &normal : normals) {
+        minDot = std::min(minDot, glm::dot(meshlet.coneAxis, normal));
+    }
+
+    // A cone wider than a hemisphere always has a triangle facing the camera
+    meshlet.coneCutoff = minDot <= 0.0f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+}
+
+} // namespace
+
+namespace lgl {
+
+std::vector<Meshlet> buildMeshlets(const std::vector<Vertex> &vertices,
+                                   const std::vector<unsigned int> &indices,
+                                   const MeshletSettings &settings) {
+    std::vector<Meshlet> meshlets;
+    if (settings.maxTriangles == 0) {
+        return meshlets;
+    }
+
+    // Index of the last meshlet using each vertex, to count unique vertices
+    constexpr auto NO_MESHLET = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> vertexMeshlets(vertices.size(), NO_MESHLET);
+
+    Meshlet meshlet{0, 0, glm::vec3(0.0f), 0.0f, glm::vec3(0.0f), 1.0f};
+    auto numVertices = 0u;
+    auto normalSum = glm::vec3(0.0f);
+    for (std::size_t i = 0; i < indices.size(); i += 3) {
+        const auto numNewVertices = std::count_if(indices.cbegin() + i, indices.cbegin() + i + 3,
+                                                  [&](const auto v){ return vertexMeshlets[v] != meshlets.size(); });
+        const auto normal = getTriangleNormal(vertices, &indices[i]);
+
+        // Also split off triangles facing away from the meshlet once it is
+        // large enough, which keeps normal cones narrow
+        const auto numTriangles = meshlet.numIndices / 3;
+        if (numTriangles == settings.maxTriangles ||
+                numVertices + numNewVertices > settings.maxVertices ||
+                (numTriangles >= settings.maxTriangles * MIN_MESHLET_FILL &&
+                 glm::dot(normal, normalSum) < MAX_MESHLET_NORMAL_COS * glm::length(normalSum))) {
+            setBounds(meshlet, vertices, indices);
+            meshlets.push_back(meshlet);
+            meshlet.firstIndex = i;
+            meshlet.numIndices = 0;
+            numVertices = 0;
+            normalSum = glm::vec3(0.0f);
+        }
+        normalSum += normal;
+
+        for (auto k = i; k < i + 3; ++k) {
+            if (vertexMeshlets[indices[k]] != meshlets.size()) {
+                vertexMeshlets[indices[k]] = meshlets.size();
+                ++numVertices;
+            }
+        }
+        meshlet.numIndices += 3;
+    }
+
+    if (meshlet.numIndices > 0) {
+        setBounds(meshlet, vertices, indices);
+        meshlets.push_back(meshlet);
+    }
+    return meshlets;
+}
+
+bool isBackfacing(const Meshlet &meshlet, const glm::vec3 &cameraPosition) {
+    const auto direction = meshlet.center - cameraPosition;
+    return glm::dot(direction, meshlet.coneAxis) >=
+           meshlet.coneCutoff * glm::length(direction) + meshlet.radius;
+}
+
+} // namespace lgl
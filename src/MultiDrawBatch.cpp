@@ -0,0 +1,167 @@
+#include <lgl/MultiDrawBatch.h>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <lgl/GlState.h>
+#include <lgl/Mesh.h>
+#include <lgl/ShaderProgram.h>
+#include <lgl/Vertex.h>
+
+namespace {
+
+// GL 4.3 is past the 3.3 core glad is generated for
+constexpr GLenum DRAW_INDIRECT_BUFFER = 0x8F3F;
+using MultiDrawElementsIndirect = void (APIENTRY *)(GLenum mode, GLenum type, const void *indirect,
+                                                    GLsizei drawCount, GLsizei stride);
+
+// Texels per draw, see MULTI_DRAW in shaders/vertex_input.glsl
+constexpr std::size_t DRAW_DATA_SIZE = 9;
+
+MultiDrawElementsIndirect getMultiDrawElementsIndirect() {
+    static const auto function = [](){
+        const auto hasVersion = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3);
+        return hasVersion ? reinterpret_cast<MultiDrawElementsIndirect>(glfwGetProcAddress("glMultiDrawElementsIndirect"))
+                          : nullptr;
+    }();
+    return function;
+}
+
+} // namespace
+
+namespace lgl {
+
+MultiDrawBatch::MultiDrawBatch() :
+    drawDataBuffer(BufferHandle::create()),
+    drawDataTexture(TextureHandle::create()),
+    drawIdBuffer(BufferHandle::create()),
+    commandBuffer(BufferHandle::create()) {
+
+    glBindBuffer(GL_TEXTURE_BUFFER, this->drawDataBuffer.get());
+    glBindTexture(GL_TEXTURE_BUFFER, this->drawDataTexture.get());
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, this->drawDataBuffer.get());
+}
+
+bool MultiDrawBatch::isIndirectSupported() {
+    return getMultiDrawElementsIndirect() != nullptr;
+}
+
+void MultiDrawBatch::add(Mesh *mesh, const glm::mat4 &model, const glm::mat3 &normal) {
+    assert(("Batched meshes must share one geometry pool",
+            mesh->getGeometryPool() && (this->draws.empty() ||
+                                        this->draws.front().mesh->getGeometryPool() == mesh->getGeometryPool())));
+
+    this->draws.push_back({mesh, model, normal});
+}
+
+void MultiDrawBatch::render(ShaderProgram *shaderProgram) {
+    this->stats = Stats();
+    if (this->draws.empty()) {
+        return;
+    }
+    this->stats.numDraws = this->draws.size();
+
+    const auto textureUnit = shaderProgram->getTextureUnit("drawData");
+    assert(("Multi draw batches need MULTI_DRAW in the vertex shader", textureUnit >= 0));
+
+    this->upload();
+
+    GlState::activeTexture(static_cast<unsigned int>(textureUnit));
+    glBindTexture(GL_TEXTURE_BUFFER, this->drawDataTexture.get());
+
+    const auto *geometryPool = this->draws.front().mesh->getGeometryPool();
+    GlState::bindVertexArray(geometryPool->getVertexArray());
+    glBindBuffer(GL_ARRAY_BUFFER, this->drawIdBuffer.get());
+    setDrawIdAttribute();
+
+    const auto multiDrawElementsIndirect = this->isIndirectEnabled ? getMultiDrawElementsIndirect() : nullptr;
+    if (multiDrawElementsIndirect) {
+        glBindBuffer(DRAW_INDIRECT_BUFFER, this->commandBuffer.get());
+        glBufferData(DRAW_INDIRECT_BUFFER, this->commands.size() * sizeof(GeometryPool::DrawCommand),
+                     this->commands.data(), GL_STREAM_DRAW);
+    }
+
+    // One call per run of draws sharing a material
+    for (std::size_t first = 0; first < this->drawOrder.size();) {
+        auto *mesh = this->draws[this->drawOrder[first]].mesh;
+        auto last = first + 1;
+        while (last < this->drawOrder.size() && this->draws[this->drawOrder[last]].mesh->hasSameMaterial(*mesh)) {
+            ++last;
+        }
+
+        mesh->bindMaterial(shaderProgram);
+        if (multiDrawElementsIndirect) {
+            multiDrawElementsIndirect(GL_TRIANGLES, geometryPool->getIndexType(),
+                                      reinterpret_cast<void *>(first * sizeof(GeometryPool::DrawCommand)),
+                                      static_cast<GLsizei>(last - first), 0);
+            ++this->stats.numCalls;
+        } else {
+            // Without base instances the draw id attribute is moved instead
+            for (auto i = first; i < last; ++i) {
+                const auto &command = this->commands[i];
+                setDrawIdAttribute(command.baseInstance);
+                glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(command.count),
+                                                  geometryPool->getIndexType(),
+                                                  reinterpret_cast<void *>(command.firstIndex * geometryPool->getIndexSize()),
+                                                  1, command.baseVertex);
+                ++this->stats.numCalls;
+            }
+        }
+        first = last;
+    }
+
+    // The pool's vertex array must not keep pointing at this batch's buffer,
+    // which is deleted with the batch
+    disableDrawIdAttribute();
+    this->clear();
+}
+
+void MultiDrawBatch::clear() {
+    this->draws.clear();
+}
+
+void MultiDrawBatch::upload() {
+    // Group draws by material, keeping submission order within a material
+    this->drawOrder.resize(this->draws.size());
+    std::iota(this->drawOrder.begin(), this->drawOrder.end(), 0u);
+    std::stable_sort(this->drawOrder.begin(), this->drawOrder.end(), [this](const auto a, const auto b){
+        return this->draws[a].mesh->getMaterialKey() < this->draws[b].mesh->getMaterialKey();
+    });
+
+    this->drawData.clear();
+    this->commands.clear();
+    for (auto i = 0u; i < this->drawOrder.size(); ++i) {
+        const auto &draw = this->draws[this->drawOrder[i]];
+        for (auto column = 0; column < 4; ++column) {
+            this->drawData.push_back(draw.model[column]);
+        }
+        for (auto column = 0; column < 3; ++column) {
+            this->drawData.emplace_back(draw.normal[column], 0.0f);
+        }
+        this->drawData.emplace_back(draw.mesh->getPositionScale(), 0.0f);
+        this->drawData.emplace_back(draw.mesh->getPositionOffset(), 0.0f);
+
+        auto command = draw.mesh->getDrawCommand();
+        command.baseInstance = i;
+        this->commands.push_back(command);
+    }
+    assert(this->drawData.size() == DRAW_DATA_SIZE * this->drawOrder.size());
+
+    glBindBuffer(GL_TEXTURE_BUFFER, this->drawDataBuffer.get());
+    glBufferData(GL_TEXTURE_BUFFER, this->drawData.size() * sizeof(glm::vec4), this->drawData.data(), GL_STREAM_DRAW);
+
+    // Draw ids only ever count up from 0, so they are uploaded as the batch grows
+    if (this->drawIdCapacity < this->draws.size()) {
+        this->drawIdCapacity = std::max(2 * this->drawIdCapacity, this->draws.size());
+        std::vector<unsigned int> drawIds(this->drawIdCapacity);
+        std::iota(drawIds.begin(), drawIds.end(), 0u);
+        glBindBuffer(GL_ARRAY_BUFFER, this->drawIdBuffer.get());
+        glBufferData(GL_ARRAY_BUFFER, drawIds.size() * sizeof(unsigned int), drawIds.data(), GL_STATIC_DRAW);
+    }
+}
+
+} // namespace lgl
@@ -0,0 +1,253 @@
+#include <lgl/OcclusionCuller.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/common.hpp>
+#include <glm/vec4.hpp>
+
+#include <lgl/Parallel.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define LGL_OCCLUSION_CULLER_SSE
+#endif
+
+namespace {
+
+// Clip space w below which a vertex counts as crossing the near plane
+constexpr float MIN_CLIP_W = 1e-5f;
+
+// Pixels per tile, with the width a multiple of 4 so that groups of four
+// pixels never straddle two tiles
+constexpr unsigned int TILE_WIDTH = 32;
+constexpr unsigned int TILE_HEIGHT = 16;
+
+} // namespace
+
+namespace lgl {
+
+OcclusionCuller::OcclusionCuller(unsigned int width, unsigned int height, unsigned int numThreads) :
+    width((width + 3) & ~3u),
+    height(height),
+    numThreads(numThreads > 0 ? numThreads : getDefaultNumThreads()),
+    depthBuffer(static_cast<std::size_t>(this->width) * height, 1.0f),
+    numTilesX((this->width + TILE_WIDTH - 1) / TILE_WIDTH),
+    numTilesY((height + TILE_HEIGHT - 1) / TILE_HEIGHT),
+    tileTriangles(static_cast<std::size_t>(this->numTilesX) * this->numTilesY) {}
+
+void OcclusionCuller::beginFrame(const glm::mat4 &viewProjectionMatrix) {
+    this->viewProjectionMatrix = viewProjectionMatrix;
+    std::fill(this->depthBuffer.begin(), this->depthBuffer.end(), 1.0f);
+    this->triangles.clear();
+    this->stats = Stats();
+}
+
+void OcclusionCuller::addOccluder(const OccluderMesh &occluder, const glm::mat4 &modelMatrix) {
+    const auto matrix = this->viewProjectionMatrix * modelMatrix;
+    const auto size = glm::vec2(this->width, this->height);
+
+    for (std::size_t i = 0; i + 2 < occluder.indices.size(); i += 3) {
+        Triangle triangle;
+        auto isClipped = false;
+        glm::vec4 clip[3];
+        for (auto k = 0; k < 3; ++k) {
+            clip[k] = matrix * glm::vec4(occluder.positions[occluder.indices[i + k]], 1.0f);
+            if (clip[k].w < MIN_CLIP_W) {
+                isClipped = true;
+                break;
+            }
+            const auto ndc = glm::vec3(clip[k]) / clip[k].w;
+            if (ndc.z < -1.0f) {
+                isClipped = true;
+                break;
+            }
+            triangle.corners[k] = glm::vec3((0.5f * glm::vec2(ndc) + 0.5f) * size, 0.5f * ndc.z + 0.5f);
+        }
+        if (isClipped) {
+            continue;
+        }
+
+        // Drop back faces and triangles entirely outside one side of the view
+        const auto &p = triangle.corners;
+        const auto area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+        const auto minCorner = glm::min(glm::min(p[0], p[1]), p[2]);
+        const auto maxCorner = glm::max(glm::max(p[0], p[1]), p[2]);
+        if (area <= 0.0f ||
+                maxCorner.x < 0.0f || maxCorner.y < 0.0f || maxCorner.z < 0.0f ||
+                minCorner.x > size.x || minCorner.y > size.y || minCorner.z > 1.0f) {
+            continue;
+        }
+        this->triangles.push_back(triangle);
+    }
+}
+
+void OcclusionCuller::rasterize() {
+    this->stats.numOccluderTriangles += this->triangles.size();
+    this->setupTriangles();
+
+    // Tiles never share pixels, so threads need no locking
+    const auto numTiles = this->tileTriangles.size();
+    parallelFor(numTiles, 1, [this](std::size_t begin, std::size_t end){
+        for (auto tile = begin; tile < end; ++tile) {
+            this->rasterizeTile(static_cast<unsigned int>(tile));
+        }
+    }, this->numThreads);
+}
+
+bool OcclusionCuller::isVisible(const Aabb &worldBounds) {
+    ++this->stats.numTested;
+
+    // Screen rectangle and nearest depth of the box's corners
+    auto minCorner = glm::vec3(std::numeric_limits<float>::max());
+    auto maxCorner = glm::vec3(std::numeric_limits<float>::lowest());
+    for (auto k = 0; k < 8; ++k) {
+        const auto corner = glm::vec3(k & 1 ? worldBounds.max.x : worldBounds.min.x,
+                                      k & 2 ? worldBounds.max.y : worldBounds.min.y,
+                                      k & 4 ? worldBounds.max.z : worldBounds.min.z);
+        const auto clip = this->viewProjectionMatrix * glm::vec4(corner, 1.0f);
+        if (clip.w < MIN_CLIP_W) {
+            return true;
+        }
+        const auto ndc = glm::vec3(clip) / clip.w;
+        const auto screen = glm::vec3((0.5f * glm::vec2(ndc) + 0.5f) * glm::vec2(this->width, this->height),
+                                      0.5f * ndc.z + 0.5f);
+        minCorner = glm::min(minCorner, screen);
+        maxCorner = glm::max(maxCorner, screen);
+    }
+
+    // Every pixel whose center the rectangle touches
+    const auto firstX = std::max(0, static_cast<int>(std::floor(minCorner.x)));
+    const auto firstY = std::max(0, static_cast<int>(std::floor(minCorner.y)));
+    const auto endX = std::min(static_cast<int>(this->width), static_cast<int>(std::floor(maxCorner.x)) + 1);
+    const auto endY = std::min(static_cast<int>(this->height), static_cast<int>(std::floor(maxCorner.y)) + 1);
+    if (firstX >= endX || firstY >= endY || minCorner.z > 1.0f || maxCorner.z < 0.0f) {
+        ++this->stats.numOccluded;
+        return false;
+    }
+
+    for (auto y = firstY; y < endY; ++y) {
+        const auto *row = &this->depthBuffer[static_cast<std::size_t>(y) * this->width];
+        if (std::any_of(row + firstX, row + endX, [&minCorner](const auto depth){ return depth >= minCorner.z; })) {
+            return true;
+        }
+    }
+    ++this->stats.numOccluded;
+    return false;
+}
+
+OcclusionCuller::Edge OcclusionCuller::getEdge(const glm::vec3 &from, const glm::vec3 &to) {
+    const auto a = from.y - to.y;
+    const auto b = to.x - from.x;
+    return {a, b, -(a * from.x + b * from.y)};
+}
+
+void OcclusionCuller::setupTriangles() {
+    this->rasterTriangles.clear();
+    for (auto &triangles : this->tileTriangles) {
+        triangles.clear();
+    }
+
+    for (const auto &triangle : this->triangles) {
+        const auto &p = triangle.corners;
+        const auto minCorner = glm::min(glm::min(p[0], p[1]), p[2]);
+        const auto maxCorner = glm::max(glm::max(p[0], p[1]), p[2]);
+
+        // Pixels whose centers may be covered, in groups of four along rows
+        RasterTriangle rasterTriangle;
+        rasterTriangle.firstX = std::max(0, static_cast<int>(std::floor(minCorner.x - 0.5f)) + 1) & ~3;
+        rasterTriangle.firstY = std::max(0, static_cast<int>(std::floor(minCorner.y - 0.5f)) + 1);
+        rasterTriangle.endX = std::min(static_cast<int>(this->width), static_cast<int>(std::floor(maxCorner.x - 0.5f)) + 1);
+        rasterTriangle.endY = std::min(static_cast<int>(this->height), static_cast<int>(std::floor(maxCorner.y - 0.5f)) + 1);
+        if (rasterTriangle.firstX >= rasterTriangle.endX || rasterTriangle.firstY >= rasterTriangle.endY) {
+            continue;
+        }
+
+        // Depth is interpolated by the edge functions of the opposite edges
+        auto &edges = rasterTriangle.edges;
+        edges[0] = getEdge(p[1], p[2]);
+        edges[1] = getEdge(p[2], p[0]);
+        edges[2] = getEdge(p[0], p[1]);
+        const auto area = edges[0].a * p[0].x + edges[0].b * p[0].y + edges[0].c;
+        rasterTriangle.depth = {0.0f, 0.0f, 0.0f};
+        for (auto k = 0; k < 3; ++k) {
+            rasterTriangle.depth.a += p[k].z * edges[k].a / area;
+            rasterTriangle.depth.b += p[k].z * edges[k].b / area;
+            rasterTriangle.depth.c += p[k].z * edges[k].c / area;
+        }
+
+        // Bin by the tiles the pixel rectangle overlaps
+        const auto index = static_cast<unsigned int>(this->rasterTriangles.size());
+        this->rasterTriangles.push_back(rasterTriangle);
+        const auto firstTileX = static_cast<unsigned int>(rasterTriangle.firstX) / TILE_WIDTH;
+        const auto firstTileY = static_cast<unsigned int>(rasterTriangle.firstY) / TILE_HEIGHT;
+        const auto endTileX = (static_cast<unsigned int>(rasterTriangle.endX) - 1) / TILE_WIDTH + 1;
+        const auto endTileY = (static_cast<unsigned int>(rasterTriangle.endY) - 1) / TILE_HEIGHT + 1;
+        for (auto tileY = firstTileY; tileY < endTileY; ++tileY) {
+            for (auto tileX = firstTileX; tileX < endTileX; ++tileX) {
+                this->tileTriangles[tileY * this->numTilesX + tileX].push_back(index);
+            }
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeTile(unsigned int tile) {
+    const auto tileX = static_cast<int>((tile % this->numTilesX) * TILE_WIDTH);
+    const auto tileY = static_cast<int>((tile / this->numTilesX) * TILE_HEIGHT);
+    const auto tileEndX = std::min(static_cast<int>(this->width), tileX + static_cast<int>(TILE_WIDTH));
+    const auto tileEndY = std::min(static_cast<int>(this->height), tileY + static_cast<int>(TILE_HEIGHT));
+
+    for (const auto index : this->tileTriangles[tile]) {
+        const auto &triangle = this->rasterTriangles[index];
+        const auto &edges = triangle.edges;
+        const auto &depth = triangle.depth;
+
+        // Both starts are multiples of 4, so groups stay aligned to the tile
+        const auto firstX = std::max(triangle.firstX, tileX);
+        const auto firstY = std::max(triangle.firstY, tileY);
+        const auto endX = std::min(triangle.endX, tileEndX);
+        const auto endY = std::min(triangle.endY, tileEndY);
+
+        for (auto y = firstY; y < endY; ++y) {
+            const auto centerY = y + 0.5f;
+            auto *row = &this->depthBuffer[static_cast<std::size_t>(y) * this->width];
+            auto x = firstX;
+
+            // Pixels centered on an edge belong to both triangles sharing it,
+            // which leaves no cracks for hidden objects to show through
+
+#ifdef LGL_OCCLUSION_CULLER_SSE
+            const auto offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            const auto zero = _mm_setzero_ps();
+            for (; x < endX; x += 4) {
+                const auto centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+                const auto evaluate = [centerX, centerY](const Edge &e){
+                    return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e.a), centerX), _mm_set1_ps(e.b * centerY + e.c));
+                };
+                const auto inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(evaluate(edges[0]), zero),
+                                                          _mm_cmpge_ps(evaluate(edges[1]), zero)),
+                                               _mm_cmpge_ps(evaluate(edges[2]), zero));
+                if (_mm_movemask_ps(inside) == 0) {
+                    continue;
+                }
+
+                const auto z = evaluate(depth);
+                const auto oldZ = _mm_loadu_ps(row + x);
+                const auto mask = _mm_and_ps(inside, _mm_cmplt_ps(z, oldZ));
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, oldZ)));
+            }
+#endif
+
+            for (; x < endX; ++x) {
+                const auto centerX = x + 0.5f;
+                const auto evaluate = [centerX, centerY](const Edge &e){ return e.a * centerX + e.b * centerY + e.c; };
+                if (evaluate(edges[0]) >= 0.0f && evaluate(edges[1]) >= 0.0f && evaluate(edges[2]) >= 0.0f) {
+                    row[x] = std::min(row[x], evaluate(depth));
+                }
+            }
+        }
+    }
+}
+
+} // namespace lgl
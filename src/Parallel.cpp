@@ -0,0 +1,135 @@
+#include <lgl/Parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Chunks of one parallelFor() call, shared by the calling thread and the
+// workers helping it
+struct Job {
+    Job(const std::function<void(std::size_t, std::size_t)> &function, std::size_t count, std::size_t chunkSize) :
+        function(function), count(count), chunkSize(chunkSize), numChunks((count + chunkSize - 1) / chunkSize) {}
+
+    void work() {
+        for (auto chunk = this->nextChunk++; chunk < this->numChunks; chunk = this->nextChunk++) {
+            const auto begin = chunk * this->chunkSize;
+            this->function(begin, std::min(begin + this->chunkSize, this->count));
+        }
+    }
+
+    const std::function<void(std::size_t, std::size_t)> &function;
+    const std::size_t count;
+    const std::size_t chunkSize;
+    const std::size_t numChunks;
+    std::atomic<std::size_t> nextChunk{0};
+
+    // Workers running the job, guarded by the pool's mutex
+    unsigned int numHelpers = 0;
+};
+
+// Threads started on first use and kept until exit. A job is queued once per
+// worker wanted, and the caller works on it as well, so jobs finish even
+// when every worker is busy, including with the job that started this one.
+class WorkerPool {
+public:
+    static WorkerPool &get() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->isStopping = true;
+        }
+        this->workAvailable.notify_all();
+        for (auto &worker : this->workers) {
+            worker.join();
+        }
+    }
+
+    void run(Job &job, unsigned int numHelpers) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            while (this->workers.size() < numHelpers) {
+                this->workers.emplace_back([this](){ this->runWorker(); });
+            }
+            this->queue.insert(this->queue.end(), numHelpers, &job);
+        }
+        this->workAvailable.notify_all();
+
+        job.work();
+
+        // Workers that haven't picked the job up yet are not needed anymore
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->queue.erase(std::remove(this->queue.begin(), this->queue.end(), &job), this->queue.end());
+        this->helperFinished.wait(lock, [&job](){ return job.numHelpers == 0; });
+    }
+
+private:
+    WorkerPool() = default;
+
+    void runWorker() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        while (true) {
+            this->workAvailable.wait(lock, [this](){ return this->isStopping || !this->queue.empty(); });
+            if (this->isStopping) {
+                return;
+            }
+
+            auto job = this->queue.front();
+            this->queue.pop_front();
+            ++job->numHelpers;
+
+            lock.unlock();
+            job->work();
+            lock.lock();
+
+            if (--job->numHelpers == 0) {
+                this->helperFinished.notify_all();
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable helperFinished;
+    std::deque<Job *> queue;
+    std::vector<std::thread> workers;
+    bool isStopping = false;
+};
+
+} // namespace
+
+namespace lgl {
+
+unsigned int getDefaultNumThreads() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void parallelFor(std::size_t count, std::size_t chunkSize,
+                 const std::function<void(std::size_t, std::size_t)> &function,
+                 unsigned int numThreads) {
+    assert(("Chunks can't be empty", chunkSize > 0));
+
+    Job job(function, count, chunkSize);
+    if (numThreads == 0) {
+        numThreads = getDefaultNumThreads();
+    }
+    numThreads = static_cast<unsigned int>(std::min<std::size_t>(numThreads, job.numChunks));
+
+    if (numThreads <= 1) {
+        job.work();
+        return;
+    }
+    WorkerPool::get().run(job, numThreads - 1);
+}
+
+} // namespace lgl
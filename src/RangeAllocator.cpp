@@ -0,0 +1,77 @@
+#include <lgl/RangeAllocator.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <numeric>
+
+namespace lgl {
+
+RangeAllocator::RangeAllocator(std::size_t capacity) {
+    this->grow(capacity);
+}
+
+bool RangeAllocator::allocate(std::size_t size, std::size_t *offset) {
+    if (size == 0) {
+        *offset = 0;
+        return true;
+    }
+
+    auto range = std::find_if(this->freeRanges.begin(), this->freeRanges.end(),
+                              [size](const auto &r){ return r.size >= size; });
+    if (range == this->freeRanges.end()) {
+        return false;
+    }
+
+    *offset = range->offset;
+    range->offset += size;
+    range->size -= size;
+    if (range->size == 0) {
+        this->freeRanges.erase(range);
+    }
+    return true;
+}
+
+void RangeAllocator::free(Range range) {
+    if (range.size == 0) {
+        return;
+    }
+    assert(("Range outside the capacity", range.offset + range.size <= this->capacity));
+
+    auto next = std::lower_bound(this->freeRanges.begin(), this->freeRanges.end(), range,
+                                 [](const auto &a, const auto &b){ return a.offset < b.offset; });
+    assert(("Range freed twice", next == this->freeRanges.end() || range.offset + range.size <= next->offset));
+    if (next != this->freeRanges.end() && range.offset + range.size == next->offset) {
+        range.size += next->size;
+        next = this->freeRanges.erase(next);
+    }
+    if (next != this->freeRanges.begin()) {
+        auto previous = std::prev(next);
+        assert(("Range freed twice", previous->offset + previous->size <= range.offset));
+        if (previous->offset + previous->size == range.offset) {
+            previous->size += range.size;
+            return;
+        }
+    }
+    this->freeRanges.insert(next, range);
+}
+
+void RangeAllocator::grow(std::size_t capacity) {
+    assert(("Range allocators only grow", capacity >= this->capacity));
+    const Range range{this->capacity, capacity - this->capacity};
+    this->capacity = capacity;
+    this->free(range);
+}
+
+void RangeAllocator::reset(std::size_t size) {
+    assert(("More in use than the capacity", size <= this->capacity));
+    this->freeRanges.clear();
+    this->free({size, this->capacity - size});
+}
+
+std::size_t RangeAllocator::getNumFree() const {
+    return std::accumulate(this->freeRanges.cbegin(), this->freeRanges.cend(), std::size_t(0),
+                           [](const auto sum, const auto &range){ return sum + range.size; });
+}
+
+} // namespace lgl
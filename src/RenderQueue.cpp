@@ -0,0 +1,187 @@
+#include <lgl/RenderQueue.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+#include <lgl/Mesh.h>
+#include <lgl/Parallel.h>
+#include <lgl/ShaderProgram.h>
+#include <lgl/UniformRingBuffer.h>
+
+namespace {
+
+constexpr unsigned int RADIX_BITS = 8;
+constexpr unsigned int NUM_BUCKETS = 1u << RADIX_BITS;
+
+} // namespace
+
+namespace lgl {
+
+void RenderQueue::submit(unsigned int pass, ShaderProgram *shaderProgram, Mesh *mesh,
+                         const glm::mat4 &model, const glm::mat3 &normal, float depth) {
+    this->commandList.submit(pass, shaderProgram, mesh, model, normal, depth);
+}
+
+void RenderQueue::record(std::size_t count, std::size_t chunkSize,
+                         const std::function<void(CommandList &, std::size_t, std::size_t)> &function,
+                         unsigned int numThreads) {
+    chunkSize = std::max(chunkSize, std::size_t(1));
+    const auto firstChunk = this->numRecordedChunks;
+    this->numRecordedChunks += (count + chunkSize - 1) / chunkSize;
+
+    parallelFor(count, chunkSize, [&](std::size_t begin, std::size_t end){
+        auto list = this->acquireList();
+        const auto firstPacket = list->getSize();
+        function(*list, begin, end);
+        this->releaseList(list, {firstChunk + begin / chunkSize, list, firstPacket, list->getSize()});
+    }, numThreads);
+}
+
+void RenderQueue::execute(UniformRingBuffer &uniformRingBuffer) {
+    this->merge();
+
+    // One flush makes the uniforms of all draws visible
+    this->drawUniformOffsets.resize(this->entries.size());
+    for (auto i = 0u; i < this->entries.size(); ++i) {
+        const auto &packet = *this->entries[i].packet;
+        uniformRingBuffer.write(packet.mesh->getDrawUniformBlock(packet.uniforms->model, packet.uniforms->normal),
+                                &this->drawUniformOffsets[i]);
+    }
+    uniformRingBuffer.flush();
+
+    const ShaderProgram *currentProgram = nullptr;
+    const Mesh *currentMesh = nullptr;
+    auto currentVertexArray = 0u;
+    auto binding = 0u;
+    for (auto i = 0u; i < this->entries.size(); ++i) {
+        const auto &packet = *this->entries[i].packet;
+
+        // Texture units depend on the program, so a new program rebinds the material
+        const auto isNewProgram = packet.shaderProgram != currentProgram;
+        if (isNewProgram) {
+            packet.shaderProgram->use();
+            currentProgram = packet.shaderProgram;
+            ++this->stats.numProgramSwitches;
+
+            const auto programBinding = packet.shaderProgram->getUniformBlockBinding("DrawUniforms");
+            assert(("Shader program lacks DRAW_UNIFORM_BLOCK", programBinding >= 0));
+            binding = static_cast<unsigned int>(programBinding);
+        }
+        if (isNewProgram || !currentMesh || !packet.mesh->hasSameMaterial(*currentMesh)) {
+            packet.mesh->bindMaterial(packet.shaderProgram);
+            ++this->stats.numMaterialSwitches;
+        }
+        const auto vertexArray = packet.mesh->getVertexArray();
+        if (vertexArray != currentVertexArray) {
+            currentVertexArray = vertexArray;
+            ++this->stats.numVertexArraySwitches;
+        }
+        currentMesh = packet.mesh;
+
+        uniformRingBuffer.bindRange(binding, this->drawUniformOffsets[i], sizeof(DrawUniformBlock));
+        packet.mesh->draw();
+    }
+
+    this->clear();
+}
+
+void RenderQueue::clear() {
+    this->commandList.clear();
+    for (auto &list : this->recordedLists) {
+        list->clear();
+    }
+    this->recordedChunks.clear();
+    this->numRecordedChunks = 0;
+    this->entries.clear();
+}
+
+std::vector<const CommandList::Packet *> RenderQueue::getSortedPackets() {
+    this->merge();
+
+    std::vector<const CommandList::Packet *> packets;
+    packets.reserve(this->entries.size());
+    for (const auto &entry : this->entries) {
+        packets.push_back(entry.packet);
+    }
+    return packets;
+}
+
+std::size_t RenderQueue::getSize() const {
+    auto size = this->commandList.getSize();
+    for (const auto &list : this->recordedLists) {
+        size += list->getSize();
+    }
+    return size;
+}
+
+CommandList *RenderQueue::acquireList() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->freeLists.empty()) {
+        this->recordedLists.emplace_back(new CommandList());
+        return this->recordedLists.back().get();
+    }
+
+    const auto list = this->freeLists.back();
+    this->freeLists.pop_back();
+    return list;
+}
+
+void RenderQueue::releaseList(CommandList *list, const RecordedChunk &recordedChunk) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->freeLists.push_back(list);
+    this->recordedChunks.push_back(recordedChunk);
+}
+
+// Gathers the packets of the queue's own list and then those of record()
+// chunks in chunk order, which the stable sort keeps for equal keys
+void RenderQueue::merge() {
+    std::sort(this->recordedChunks.begin(), this->recordedChunks.end(),
+              [](const RecordedChunk &a, const RecordedChunk &b){ return a.chunk < b.chunk; });
+
+    this->entries.clear();
+    for (const auto &packet : this->commandList.getPackets()) {
+        this->entries.push_back({packet.key, &packet});
+    }
+    for (const auto &recordedChunk : this->recordedChunks) {
+        const auto &packets = recordedChunk.list->getPackets();
+        for (auto i = recordedChunk.begin; i < recordedChunk.end; ++i) {
+            this->entries.push_back({packets[i].key, &packets[i]});
+        }
+    }
+
+    this->stats = Stats();
+    this->stats.numCommands = this->entries.size();
+    this->sort();
+}
+
+// Least significant digit radix sort, which keeps draws with equal keys in
+// submission order. Digits every key shares are skipped, which with few
+// passes and programs leaves most of the high bytes out.
+void RenderQueue::sort() {
+    this->sortBuffer.resize(this->entries.size());
+
+    std::array<std::size_t, NUM_BUCKETS> offsets;
+    for (auto shift = 0u; shift < 64; shift += RADIX_BITS) {
+        offsets.fill(0);
+        for (const auto &entry : this->entries) {
+            ++offsets[(entry.key >> shift) & (NUM_BUCKETS - 1)];
+        }
+        if (std::find(offsets.cbegin(), offsets.cend(), this->entries.size()) != offsets.cend()) {
+            continue;
+        }
+
+        auto offset = std::size_t(0);
+        for (auto &bucket : offsets) {
+            const auto size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (const auto &entry : this->entries) {
+            this->sortBuffer[offsets[(entry.key >> shift) & (NUM_BUCKETS - 1)]++] = entry;
+        }
+        this->entries.swap(this->sortBuffer);
+    }
+}
+
+} // namespace lgl
@@ -0,0 +1,90 @@
+#include <lgl/SceneGraph.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include <glm/matrix.hpp>
+
+namespace lgl {
+
+constexpr SceneGraph::NodeId SceneGraph::ROOT_NODE;
+
+SceneGraph::SceneGraph() :
+    parents{ROOT_NODE},
+    children(1),
+    localTransforms{glm::mat4(1.0f)},
+    worldTransforms{glm::mat4(1.0f)},
+    normalMatrices{glm::mat3(1.0f)},
+    isNodeDirty{false} {}
+
+SceneGraph::NodeId SceneGraph::createNode(NodeId parent, const glm::mat4 &localTransform) {
+    const auto node = static_cast<NodeId>(this->parents.size());
+    this->parents.push_back(parent);
+    this->children.emplace_back();
+    this->children[parent].push_back(node);
+    this->localTransforms.push_back(localTransform);
+    this->worldTransforms.emplace_back(1.0f);
+    this->normalMatrices.emplace_back(1.0f);
+    this->isNodeDirty.push_back(false);
+    this->markDirty(node);
+    return node;
+}
+
+void SceneGraph::setParent(NodeId node, NodeId parent) {
+    assert(("The root node can't be reparented", node != ROOT_NODE));
+    for (auto ancestor = parent; ancestor != ROOT_NODE; ancestor = this->parents[ancestor]) {
+        assert(("A node can't be moved below itself", ancestor != node));
+    }
+
+    auto &siblings = this->children[this->parents[node]];
+    siblings.erase(std::find(siblings.begin(), siblings.end(), node));
+    this->children[parent].push_back(node);
+    this->parents[node] = parent;
+    this->markDirty(node);
+}
+
+void SceneGraph::setLocalTransform(NodeId node, const glm::mat4 &localTransform) {
+    this->localTransforms[node] = localTransform;
+    this->markDirty(node);
+}
+
+std::size_t SceneGraph::update() {
+    // Start from dirty nodes without dirty ancestors, whose subtrees cover
+    // all other dirty nodes
+    this->updateQueue.clear();
+    for (auto node : this->dirtyNodes) {
+        auto hasDirtyAncestor = false;
+        for (auto ancestor = node; ancestor != ROOT_NODE && !hasDirtyAncestor;) {
+            ancestor = this->parents[ancestor];
+            hasDirtyAncestor = this->isNodeDirty[ancestor];
+        }
+        if (!hasDirtyAncestor) {
+            this->updateQueue.push_back(node);
+        }
+    }
+    this->dirtyNodes.clear();
+
+    // Parents are always recomputed before their children
+    for (std::size_t i = 0; i < this->updateQueue.size(); ++i) {
+        const auto node = this->updateQueue[i];
+        this->worldTransforms[node] = node == ROOT_NODE ?
+                    this->localTransforms[node] :
+                    this->worldTransforms[this->parents[node]] * this->localTransforms[node];
+        this->normalMatrices[node] = glm::transpose(glm::inverse(glm::mat3(this->worldTransforms[node])));
+        this->isNodeDirty[node] = false;
+
+        const auto &nodeChildren = this->children[node];
+        this->updateQueue.insert(this->updateQueue.cend(), nodeChildren.cbegin(), nodeChildren.cend());
+    }
+    return this->updateQueue.size();
+}
+
+void SceneGraph::markDirty(NodeId node) {
+    ++this->version;
+    if (!this->isNodeDirty[node]) {
+        this->isNodeDirty[node] = true;
+        this->dirtyNodes.push_back(node);
+    }
+}
+
+} // namespace lgl
@@ -1,55 +1,107 @@
 #include <lgl/Shader.h>
 
-#include <iterator>
-#include <fstream>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <memory>
 #include <vector>
 
 #include <glad/glad.h>
 
+#define STB_INCLUDE_IMPLEMENTATION
+#define STB_INCLUDE_LINE_GLSL
+#include <stb/stb_include.h>
+
 #include <lgl/Exception.h>
 
 namespace {
 
-void deleteShader(unsigned int *shader) {
-    glDeleteShader(*shader);
-    delete shader;
+std::vector<char> toCString(const std::string &str) {
+    std::vector<char> cStr(str.cbegin(), str.cend());
+    cStr.push_back('\0');
+    return cStr;
+}
+
+std::string preprocess(const std::string &pathname, const lgl::ShaderDefines &defines) {
+    // Expand #include directives, which are resolved relative to the shader's directory
+    const auto dirEnd = pathname.find_last_of("/\\");
+    const auto dir = dirEnd == std::string::npos ? std::string(".") : pathname.substr(0, dirEnd);
+
+    auto filename = toCString(pathname);
+    auto includeDir = toCString(dir);
+    std::array<char, 256> error{};
+    std::unique_ptr<char, void(*)(void *)> expandedCode(
+                stb_include_file(filename.data(), nullptr, includeDir.data(), error.data()),
+                std::free);
+    if (!expandedCode) {
+        throw lgl::LoadError("Failed to load shader: " + std::string(error.data()));
+    }
+
+    std::string shaderCode(expandedCode.get());
+    if (defines.empty()) {
+        return shaderCode;
+    }
+
+    // Inject defines after #version since it must be the first directive
+    auto insertPos = shaderCode.find("#version");
+    if (insertPos != std::string::npos) {
+        insertPos = shaderCode.find('\n', insertPos);
+        if (insertPos == std::string::npos) {
+            shaderCode.push_back('\n');
+            insertPos = shaderCode.size();
+        } else {
+            ++insertPos;
+        }
+    } else {
+        insertPos = 0;
+    }
+
+    std::string defineCode;
+    for (const auto &define : defines) {
+        defineCode += "#define " + define.first + " " + define.second + "\n";
+    }
+
+    // Keep compiler error line numbers matching the source file
+    const auto nextLine = std::count(shaderCode.cbegin(), shaderCode.cbegin() + insertPos, '\n') + 1;
+    defineCode += "#line " + std::to_string(nextLine) + "\n";
+
+    shaderCode.insert(insertPos, defineCode);
+    return shaderCode;
 }
 
 } // namespace
 
 namespace lgl {
 
-Shader::Shader(const std::string &pathname, int type) :
-    shader(new unsigned int(glCreateShader(type)), deleteShader) {
+Shader::Shader(const std::string &pathname, int type, const ShaderDefines &defines) :
+    shader(glCreateShader(type)) {
 
-    // Read shader source file
-    std::ifstream file(pathname);
-    std::vector<char> shaderCode((std::istreambuf_iterator<char>(file)),
-                                 std::istreambuf_iterator<char>());
-    auto shaderCodePtr = &shaderCode[0];
+    // Read and preprocess shader source file
+    const auto shaderCode = preprocess(pathname, defines);
+    auto shaderCodePtr = shaderCode.c_str();
     std::array<int, 1> shaderCodeLength{static_cast<int>(shaderCode.size())};
 
     // Compile shader
-    glShaderSource(*this->shader, 1, &shaderCodePtr, &shaderCodeLength[0]);
-    glCompileShader(*this->shader);
+    glShaderSource(this->shader.get(), 1, &shaderCodePtr, &shaderCodeLength[0]);
+    glCompileShader(this->shader.get());
 
     int status;
-    glGetShaderiv(*this->shader, GL_COMPILE_STATUS, &status);
+    glGetShaderiv(this->shader.get(), GL_COMPILE_STATUS, &status);
     if (!status) {
         int logLength = 0;
-        glGetShaderiv(*this->shader, GL_INFO_LOG_LENGTH, &logLength);
+        glGetShaderiv(this->shader.get(), GL_INFO_LOG_LENGTH, &logLength);
         std::vector<char> log(logLength);
-        glGetShaderInfoLog(*this->shader, logLength, nullptr, log.data());
+        glGetShaderInfoLog(this->shader.get(), logLength, nullptr, log.data());
         throw BuildError(std::string(log.cbegin(), log.cend()));
     }
 }
 
 void Shader::attachToShaderProgram(unsigned int program) {
-    glAttachShader(program, *this->shader);
+    glAttachShader(program, this->shader.get());
 }
 
 void Shader::detachFromShaderProgram(unsigned int program) {
-    glDetachShader(program, *this->shader);
+    glDetachShader(program, this->shader.get());
 }
 
 } // namespace lgl
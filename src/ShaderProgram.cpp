@@ -1,85 +1,249 @@
 #include <lgl/ShaderProgram.h>
 
 #include <cassert>
+#include <cstring>
 #include <vector>
 
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
 
 #include <lgl/Exception.h>
+#include <lgl/GlState.h>
 #include <lgl/Shader.h>
 
 namespace {
-void deleteProgram(unsigned int *program) {
-    glDeleteProgram(*program);
-    delete program;
+
+bool isSamplerType(GLenum type) {
+    switch (type) {
+    case GL_SAMPLER_1D:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_3D:
+    case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_1D_SHADOW:
+    case GL_SAMPLER_2D_SHADOW:
+    case GL_SAMPLER_1D_ARRAY:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_1D_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_MULTISAMPLE:
+    case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_SAMPLER_CUBE_SHADOW:
+    case GL_SAMPLER_BUFFER:
+    case GL_SAMPLER_2D_RECT:
+    case GL_SAMPLER_2D_RECT_SHADOW:
+    case GL_INT_SAMPLER_1D:
+    case GL_INT_SAMPLER_2D:
+    case GL_INT_SAMPLER_3D:
+    case GL_INT_SAMPLER_CUBE:
+    case GL_INT_SAMPLER_1D_ARRAY:
+    case GL_INT_SAMPLER_2D_ARRAY:
+    case GL_INT_SAMPLER_2D_MULTISAMPLE:
+    case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_INT_SAMPLER_BUFFER:
+    case GL_INT_SAMPLER_2D_RECT:
+    case GL_UNSIGNED_INT_SAMPLER_1D:
+    case GL_UNSIGNED_INT_SAMPLER_2D:
+    case GL_UNSIGNED_INT_SAMPLER_3D:
+    case GL_UNSIGNED_INT_SAMPLER_CUBE:
+    case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+    case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+        return true;
+    default:
+        return false;
+    }
 }
+
 } // namespace
 
 namespace lgl {
 
 ShaderProgram::ShaderProgram(const std::string &vertexShaderPathname,
-                             const std::string &fragmentShaderPathname) :
-    program(new unsigned int(glCreateProgram()), deleteProgram) {
+                             const std::string &fragmentShaderPathname,
+                             const ShaderDefines &defines) :
+    program(ProgramHandle::create()) {
 
-    Shader vertexShader(vertexShaderPathname, GL_VERTEX_SHADER);
-    Shader fragmentShader(fragmentShaderPathname, GL_FRAGMENT_SHADER);
+    Shader vertexShader(vertexShaderPathname, GL_VERTEX_SHADER, defines);
+    Shader fragmentShader(fragmentShaderPathname, GL_FRAGMENT_SHADER, defines);
 
-    vertexShader.attachToShaderProgram(*this->program);
-    fragmentShader.attachToShaderProgram(*this->program);
-    glLinkProgram(*this->program);
-    fragmentShader.detachFromShaderProgram(*this->program);
-    vertexShader.detachFromShaderProgram(*this->program);
+    vertexShader.attachToShaderProgram(this->program.get());
+    fragmentShader.attachToShaderProgram(this->program.get());
+    glLinkProgram(this->program.get());
+    fragmentShader.detachFromShaderProgram(this->program.get());
+    vertexShader.detachFromShaderProgram(this->program.get());
 
     int status;
-    glGetProgramiv(*this->program, GL_LINK_STATUS, &status);
+    glGetProgramiv(this->program.get(), GL_LINK_STATUS, &status);
     if (!status) {
         int logLength;
-        glGetProgramiv(*this->program, GL_INFO_LOG_LENGTH, &logLength);
+        glGetProgramiv(this->program.get(), GL_INFO_LOG_LENGTH, &logLength);
         std::vector<char> log(logLength);
-        glGetProgramInfoLog(*this->program, logLength, nullptr, log.data());
+        glGetProgramInfoLog(this->program.get(), logLength, nullptr, log.data());
         throw BuildError(std::string(log.cbegin(), log.cend()));
     }
+
+    this->loadActiveUniforms();
+    this->loadUniformBlocks();
+}
+
+void ShaderProgram::loadActiveUniforms() {
+    int numUniforms;
+    glGetProgramiv(this->program.get(), GL_ACTIVE_UNIFORMS, &numUniforms);
+
+    int maxNameLength;
+    glGetProgramiv(this->program.get(), GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    std::vector<char> nameBuffer(maxNameLength);
+
+    // Samplers get fixed texture units, which requires the program to be bound
+    int previousProgram;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+    glUseProgram(this->program.get());
+    auto nextTextureUnit = 0;
+
+    for (auto i = 0; i < numUniforms; ++i) {
+        int nameLength, size;
+        GLenum type;
+        glGetActiveUniform(this->program.get(), i, maxNameLength, &nameLength,
+                           &size, &type, nameBuffer.data());
+        std::string name(nameBuffer.data(), nameLength);
+
+        const auto location = glGetUniformLocation(this->program.get(), name.c_str());
+        if (location == -1) {
+            continue; // Uniform block member
+        }
+
+        // Arrays of basic types are reported once as "name[0]"
+        const auto arraySuffixPos = name.size() - 3;
+        if (name.size() > 3 && name.compare(arraySuffixPos, 3, "[0]") == 0) {
+            const auto baseName = name.substr(0, arraySuffixPos);
+            this->uniforms[baseName].location = location;
+            for (auto j = 0; j < size; ++j) {
+                const auto elementName = baseName + "[" + std::to_string(j) + "]";
+                this->uniforms[elementName].location = glGetUniformLocation(this->program.get(),
+                                                                            elementName.c_str());
+                if (isSamplerType(type)) {
+                    this->assignTextureUnit(elementName, nextTextureUnit++);
+                }
+            }
+
+            if (isSamplerType(type)) {
+                this->uniforms[baseName] = this->uniforms[name];
+            }
+        } else {
+            this->uniforms[name].location = location;
+            if (isSamplerType(type)) {
+                this->assignTextureUnit(name, nextTextureUnit++);
+            }
+        }
+    }
+
+    glUseProgram(previousProgram);
+}
+
+void ShaderProgram::assignTextureUnit(const std::string &samplerName, int textureUnit) {
+    auto &uniform = this->uniforms[samplerName];
+    uniform.isSampler = true;
+    uniform.isSet = true;
+    std::memcpy(uniform.value.data(), &textureUnit, sizeof(textureUnit));
+    glUniform1i(uniform.location, textureUnit);
+}
+
+void ShaderProgram::loadUniformBlocks() {
+    int numBlocks;
+    glGetProgramiv(this->program.get(), GL_ACTIVE_UNIFORM_BLOCKS, &numBlocks);
+
+    int maxNameLength;
+    glGetProgramiv(this->program.get(), GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxNameLength);
+    std::vector<char> nameBuffer(maxNameLength);
+
+    // Blocks get fixed binding points, like samplers get texture units
+    for (auto i = 0; i < numBlocks; ++i) {
+        int nameLength;
+        glGetActiveUniformBlockName(this->program.get(), i, maxNameLength, &nameLength, nameBuffer.data());
+        glUniformBlockBinding(this->program.get(), i, i);
+        this->uniformBlockBindings[std::string(nameBuffer.data(), nameLength)] = i;
+    }
+}
+
+int ShaderProgram::getUniformBlockBinding(const std::string &blockName) const {
+    const auto binding = this->uniformBlockBindings.find(blockName);
+    return binding == this->uniformBlockBindings.cend() ? -1 : binding->second;
+}
+
+int ShaderProgram::getTextureUnit(const std::string &samplerName) const {
+    const auto uniform = this->uniforms.find(samplerName);
+    if (uniform == this->uniforms.cend() || !uniform->second.isSampler) {
+        return -1;
+    }
+
+    int textureUnit;
+    std::memcpy(&textureUnit, uniform->second.value.data(), sizeof(textureUnit));
+    return textureUnit;
+}
+
+template<typename T>
+ShaderProgram::Uniform *ShaderProgram::updateUniform(const std::string &name, const T &value) {
+    static_assert(sizeof(T) <= sizeof(Uniform::value), "Uniform value too large");
+
+    auto uniform = this->uniforms.find(name);
+    assert(("Failed to glGetUniformLocation()", uniform != this->uniforms.end()));
+    if (uniform == this->uniforms.end()) {
+        return nullptr;
+    }
+
+    if (uniform->second.isSet &&
+            std::memcmp(uniform->second.value.data(), &value, sizeof(T)) == 0) {
+        ++this->uniformStats.numSkipped;
+        return nullptr;
+    }
+
+    std::memcpy(uniform->second.value.data(), &value, sizeof(T));
+    uniform->second.isSet = true;
+    ++this->uniformStats.numIssued;
+    return &uniform->second;
 }
 
 void ShaderProgram::use() const {
-    glUseProgram(*this->program);
+    GlState::useProgram(this->program.get());
 }
 
 void ShaderProgram::setUniform(const std::string &name, float value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniform1f(location, value);
+    if (auto uniform = this->updateUniform(name, value)) {
+        glUniform1f(uniform->location, value);
+    }
 }
 
 void ShaderProgram::setUniform(const std::string &name, int value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniform1i(location, value);
+    if (auto uniform = this->updateUniform(name, value)) {
+        glUniform1i(uniform->location, value);
+    }
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::vec3 &value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniform3f(location, value.x, value.y, value.z);
+    if (auto uniform = this->updateUniform(name, value)) {
+        glUniform3f(uniform->location, value.x, value.y, value.z);
+    }
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::vec4 &value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniform4f(location, value.x, value.y, value.z, value.w);
+    if (auto uniform = this->updateUniform(name, value)) {
+        glUniform4f(uniform->location, value.x, value.y, value.z, value.w);
+    }
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::mat3 &value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+    if (auto uniform = this->updateUniform(name, value)) {
+        glUniformMatrix3fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
+    }
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::mat4 &value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+    if (auto uniform = this->updateUniform(name, value)) {
+        glUniformMatrix4fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
+    }
 }
 
 } // namespace lgl
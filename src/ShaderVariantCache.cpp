@@ -0,0 +1,25 @@
+#include <lgl/ShaderVariantCache.h>
+
+#include <tuple>
+#include <utility>
+
+namespace lgl {
+
+ShaderVariantCache::ShaderVariantCache(const std::string &vertexShaderPathname,
+                                       const std::string &fragmentShaderPathname) :
+    vertexShaderPathname(vertexShaderPathname),
+    fragmentShaderPathname(fragmentShaderPathname) {}
+
+ShaderProgram *ShaderVariantCache::getVariant(const ShaderDefines &defines) {
+    auto variant = this->variants.find(defines);
+    if (variant == this->variants.end()) {
+        variant = this->variants.emplace(std::piecewise_construct,
+                                         std::forward_as_tuple(defines),
+                                         std::forward_as_tuple(this->vertexShaderPathname,
+                                                               this->fragmentShaderPathname,
+                                                               defines)).first;
+    }
+    return &variant->second;
+}
+
+} // namespace lgl
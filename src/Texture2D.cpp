@@ -1,35 +1,42 @@
 #include <lgl/Texture2D.h>
 
+#include <memory>
 #include <unordered_map>
+#include <utility>
 
 #include <glad/glad.h>
 #include <stb/stb_image.h>
 
 #include <lgl/Exception.h>
+#include <lgl/GlHandle.h>
+#include <lgl/GlState.h>
+
+namespace lgl {
+
+// Cache entry referenced by Texture2D instances without atomic reference counting
+struct SharedTexture {
+    TextureHandle texture;
+    unsigned int numReferences = 0;
+    const std::string *pathname = nullptr;
+};
+
+} // namespace lgl
 
 namespace {
 
-using TexturePtr = std::weak_ptr<unsigned int>;
-using TextureCache = std::unordered_map<std::string, TexturePtr>;
-TextureCache cache;
+std::unordered_map<std::string, lgl::SharedTexture> cache;
 
 } // namespace
 
 namespace lgl {
 
-Texture2D::Texture2D(const std::string &pathname) :
-    texture(cache[pathname].lock()) {
-    if (this->texture) {
+Texture2D::Texture2D(const std::string &pathname) {
+    const auto cachedTexture = cache.find(pathname);
+    if (cachedTexture != cache.end()) {
+        this->texture = &cachedTexture->second;
+        ++this->texture->numReferences;
         return;
-    };
-
-    this->texture.reset(new unsigned int, [pathname](auto texture){
-        glDeleteTextures(1, texture);
-        cache.erase(pathname);
-        delete texture;
-    });
-    glGenTextures(1, this->texture.get());
-    cache[pathname] = this->texture;
+    }
 
     stbi_set_flip_vertically_on_load(true);
     int width, height, numChannels;
@@ -49,7 +56,13 @@ Texture2D::Texture2D(const std::string &pathname) :
     default: format = GL_RGB; break;
     }
 
-    glBindTexture(GL_TEXTURE_2D, *this->texture);
+    const auto entry = cache.emplace(pathname, SharedTexture()).first;
+    this->texture = &entry->second;
+    this->texture->texture = TextureHandle::create();
+    this->texture->numReferences = 1;
+    this->texture->pathname = &entry->first;
+
+    GlState::bindTexture2D(this->texture->texture.get());
     glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0,
                  format, GL_UNSIGNED_BYTE, imgData.get());
     glGenerateMipmap(GL_TEXTURE_2D);
@@ -60,8 +73,33 @@ Texture2D::Texture2D(const std::string &pathname) :
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 }
 
+Texture2D::Texture2D(const Texture2D &other) :
+    texture(other.texture) {
+    ++this->texture->numReferences;
+}
+
+Texture2D::Texture2D(Texture2D &&other) noexcept :
+    texture(other.texture) {
+    other.texture = nullptr;
+}
+
+Texture2D &Texture2D::operator=(Texture2D other) noexcept {
+    std::swap(this->texture, other.texture);
+    return *this;
+}
+
+Texture2D::~Texture2D() {
+    if (this->texture && --this->texture->numReferences == 0) {
+        cache.erase(cache.find(*this->texture->pathname));
+    }
+}
+
 void Texture2D::bind() {
-    glBindTexture(GL_TEXTURE_2D, *this->texture);
+    GlState::bindTexture2D(this->texture->texture.get());
+}
+
+unsigned int Texture2D::getId() const {
+    return this->texture->texture.get();
 }
 
 } // namespace lgl
@@ -0,0 +1,264 @@
+#include <lgl/TransformBatch.h>
+
+#include <atomic>
+#include <utility>
+
+#include <glad/glad.h>
+
+#include <lgl/Frame.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define LGL_TRANSFORM_BATCH_SSE
+#endif
+
+namespace {
+
+std::atomic<unsigned long> nextVersion(0);
+
+void computeTransform(const std::vector<float> (&positions)[3],
+                      const std::vector<float> (&orientations)[4],
+                      const std::vector<float> (&scales)[3],
+                      std::size_t i, lgl::InstanceTransform &output) {
+    // model = [R * S | p], normal = transpose(inverse(R * S)) = R * inverse(S)
+    const auto rotation = glm::mat3_cast(glm::quat(orientations[3][i], orientations[0][i],
+                                                   orientations[1][i], orientations[2][i]));
+    for (auto column = 0; column < 3; ++column) {
+        const auto scale = scales[column][i];
+        for (auto row = 0; row < 3; ++row) {
+            const auto r = rotation[column][row];
+            output.model[column][row] = r * scale;
+            output.normal[column][row] = r / scale;
+        }
+        output.model[column][3] = 0.0f;
+        output.model[3][column] = positions[column][i];
+    }
+    output.model[3][3] = 1.0f;
+}
+
+#ifdef LGL_TRANSFORM_BATCH_SSE
+// Transposes x, y, z and w of four objects into one vec4 per object
+void storeColumns(__m128 x, __m128 y, __m128 z, __m128 w, float *outputs[4]) {
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(outputs[0], x);
+    _mm_storeu_ps(outputs[1], y);
+    _mm_storeu_ps(outputs[2], z);
+    _mm_storeu_ps(outputs[3], w);
+}
+
+// Like storeColumns for vec3s, leaving the float after each untouched
+void storeColumns3(__m128 x, __m128 y, __m128 z, float *outputs[4]) {
+    auto w = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    const __m128 columns[] = {x, y, z, w};
+    for (auto k = 0; k < 4; ++k) {
+        _mm_storel_pi(reinterpret_cast<__m64 *>(outputs[k]), columns[k]);
+        _mm_store_ss(outputs[k] + 2, _mm_movehl_ps(columns[k], columns[k]));
+    }
+}
+
+// Columns of the rotation matrices of four unit quaternions
+void getRotationColumns(__m128 x, __m128 y, __m128 z, __m128 w, __m128 (&columns)[3][3]) {
+    const auto one = _mm_set1_ps(1.0f);
+    const auto two = _mm_set1_ps(2.0f);
+    const auto xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+    const auto xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+    const auto wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+    columns[0][0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+    columns[0][1] = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+    columns[0][2] = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+    columns[1][0] = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+    columns[1][1] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+    columns[1][2] = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+    columns[2][0] = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+    columns[2][1] = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+    columns[2][2] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+}
+#endif
+
+} // namespace
+
+namespace lgl {
+
+static_assert(sizeof(DrawUniformBlock) == 144, "DrawUniformBlock must match the std140 DrawUniforms block");
+
+DrawUniformBlock::DrawUniformBlock(const glm::mat4 &model, const glm::mat3 &normal) :
+    DrawUniformBlock(model, normal, glm::vec3(1.0f), glm::vec3(0.0f), 0.0f) {}
+
+DrawUniformBlock::DrawUniformBlock(const glm::mat4 &model, const glm::mat3 &normal,
+                                   const glm::vec3 &positionScale, const glm::vec3 &positionOffset, float shine) :
+    model(model),
+    normal{glm::vec4(normal[0], 0.0f), glm::vec4(normal[1], 0.0f), glm::vec4(normal[2], 0.0f)},
+    positionScale(positionScale),
+    shine(shine),
+    positionOffset(positionOffset, 0.0f) {}
+
+TransformBatch::TransformBatch(const TransformBatch &other) {
+    *this = other;
+}
+
+TransformBatch::TransformBatch(TransformBatch &&other) {
+    *this = std::move(other);
+}
+
+TransformBatch &TransformBatch::operator=(const TransformBatch &other) {
+    for (auto k = 0; k < 3; ++k) {
+        this->positions[k] = other.positions[k];
+        this->scales[k] = other.scales[k];
+    }
+    for (auto k = 0; k < 4; ++k) {
+        this->orientations[k] = other.orientations[k];
+    }
+    this->version = getNextVersion();
+    return *this;
+}
+
+TransformBatch &TransformBatch::operator=(TransformBatch &&other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    for (auto k = 0; k < 3; ++k) {
+        this->positions[k] = std::move(other.positions[k]);
+        this->scales[k] = std::move(other.scales[k]);
+    }
+    for (auto k = 0; k < 4; ++k) {
+        this->orientations[k] = std::move(other.orientations[k]);
+    }
+    this->version = getNextVersion();
+    other.clear();
+    return *this;
+}
+
+TransformBatch::Index TransformBatch::add(const Frame &frame) {
+    return this->add(frame.getPosition(), frame.getOrientationQuaternion(), frame.getScale());
+}
+
+TransformBatch::Index TransformBatch::add(const glm::vec3 &position, const glm::quat &orientation,
+                                          const glm::vec3 &scale) {
+    const auto i = static_cast<Index>(this->getSize());
+    for (auto &p : this->positions) {
+        p.push_back(0.0f);
+    }
+    for (auto &o : this->orientations) {
+        o.push_back(0.0f);
+    }
+    for (auto &s : this->scales) {
+        s.push_back(0.0f);
+    }
+
+    this->setPosition(i, position);
+    this->setOrientation(i, orientation);
+    this->setScale(i, scale);
+    return i;
+}
+
+void TransformBatch::set(Index i, const Frame &frame) {
+    this->setPosition(i, frame.getPosition());
+    this->setOrientation(i, frame.getOrientationQuaternion());
+    this->setScale(i, frame.getScale());
+}
+
+void TransformBatch::setPosition(Index i, const glm::vec3 &position) {
+    this->version = getNextVersion();
+    for (auto k = 0; k < 3; ++k) {
+        this->positions[k][i] = position[k];
+    }
+}
+
+void TransformBatch::setOrientation(Index i, const glm::quat &orientation) {
+    this->version = getNextVersion();
+    this->orientations[0][i] = orientation.x;
+    this->orientations[1][i] = orientation.y;
+    this->orientations[2][i] = orientation.z;
+    this->orientations[3][i] = orientation.w;
+}
+
+void TransformBatch::setScale(Index i, const glm::vec3 &scale) {
+    this->version = getNextVersion();
+    for (auto k = 0; k < 3; ++k) {
+        this->scales[k][i] = scale[k];
+    }
+}
+
+void TransformBatch::clear() {
+    for (auto &p : this->positions) {
+        p.clear();
+    }
+    for (auto &o : this->orientations) {
+        o.clear();
+    }
+    for (auto &s : this->scales) {
+        s.clear();
+    }
+    this->version = getNextVersion();
+}
+
+unsigned long TransformBatch::getNextVersion() {
+    return nextVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+void TransformBatch::computeTransforms(InstanceTransform *output) const {
+    const auto size = this->getSize();
+    std::size_t i = 0;
+
+#ifdef LGL_TRANSFORM_BATCH_SSE
+    const auto zero = _mm_setzero_ps();
+    const auto one = _mm_set1_ps(1.0f);
+    float *outputs[4];
+    __m128 rotation[3][3];
+    for (; i + 4 <= size; i += 4) {
+        getRotationColumns(_mm_loadu_ps(&this->orientations[0][i]), _mm_loadu_ps(&this->orientations[1][i]),
+                           _mm_loadu_ps(&this->orientations[2][i]), _mm_loadu_ps(&this->orientations[3][i]),
+                           rotation);
+
+        for (auto column = 0; column < 3; ++column) {
+            const auto scale = _mm_loadu_ps(&this->scales[column][i]);
+            const auto inverseScale = _mm_div_ps(one, scale);
+            const auto x = rotation[column][0];
+            const auto y = rotation[column][1];
+            const auto z = rotation[column][2];
+
+            for (auto k = 0; k < 4; ++k) {
+                outputs[k] = &output[i + k].model[column][0];
+            }
+            storeColumns(_mm_mul_ps(x, scale), _mm_mul_ps(y, scale), _mm_mul_ps(z, scale), zero, outputs);
+
+            for (auto k = 0; k < 4; ++k) {
+                outputs[k] = &output[i + k].normal[column][0];
+            }
+            storeColumns3(_mm_mul_ps(x, inverseScale), _mm_mul_ps(y, inverseScale),
+                          _mm_mul_ps(z, inverseScale), outputs);
+        }
+
+        for (auto k = 0; k < 4; ++k) {
+            outputs[k] = &output[i + k].model[3][0];
+        }
+        storeColumns(_mm_loadu_ps(&this->positions[0][i]), _mm_loadu_ps(&this->positions[1][i]),
+                     _mm_loadu_ps(&this->positions[2][i]), one, outputs);
+    }
+#endif
+
+    for (; i < size; ++i) {
+        computeTransform(this->positions, this->orientations, this->scales, i, output[i]);
+    }
+}
+
+void TransformBatch::writeInstanceBuffer(unsigned int buffer) const {
+    const auto size = this->getSize() * sizeof(InstanceTransform);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    if (size == 0) {
+        return;
+    }
+
+    // Orphan the old storage so the driver never waits for draws still
+    // reading it
+    auto *output = static_cast<InstanceTransform *>(
+                glMapBufferRange(GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    this->computeTransforms(output);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+} // namespace lgl
@@ -0,0 +1,190 @@
+#include <lgl/UniformRingBuffer.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+namespace {
+
+// GL 4.4 is past the 3.3 core glad is generated for
+constexpr GLbitfield MAP_PERSISTENT_BIT = 0x0040;
+constexpr GLbitfield MAP_COHERENT_BIT = 0x0080;
+using BufferStorage = void (APIENTRY *)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+// A fence is polled this often, and given up on after MAX_FENCE_WAITS polls,
+// so that a lost context can't hang the wait forever
+constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000;
+constexpr int MAX_FENCE_WAITS = 1000;
+
+BufferStorage getBufferStorage() {
+    static const auto function = [](){
+        const auto hasVersion = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4);
+        return hasVersion ? reinterpret_cast<BufferStorage>(glfwGetProcAddress("glBufferStorage")) : nullptr;
+    }();
+    return function;
+}
+
+std::size_t alignUp(std::size_t offset, std::size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+namespace lgl {
+
+UniformRingBuffer::UniformRingBuffer(std::size_t frameSize) {
+    int offsetAlignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+    this->alignment = static_cast<std::size_t>(std::max(offsetAlignment, 1));
+    this->frameSize = alignUp(std::max(frameSize, std::size_t(1)), this->alignment);
+    this->createStorage();
+}
+
+UniformRingBuffer::~UniformRingBuffer() {
+    for (auto fence : this->fences) {
+        if (fence) {
+            glDeleteSync(static_cast<GLsync>(fence));
+        }
+    }
+}
+
+void UniformRingBuffer::beginFrame() {
+    assert(("Ring buffer frame already begun", !this->isInFrame));
+    this->isInFrame = true;
+    this->frame = (this->frame + 1) % NUM_FRAMES;
+    this->head = this->frame * this->frameSize;
+    this->frameBytes = 0;
+
+    auto &fence = this->fences[this->frame];
+    if (!fence) {
+        return;
+    }
+
+    const auto sync = static_cast<GLsync>(fence);
+    if (glClientWaitSync(sync, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        ++this->stats.numStalls;
+        const auto stallStart = std::chrono::steady_clock::now();
+        auto status = GL_TIMEOUT_EXPIRED;
+        for (auto i = 0; i < MAX_FENCE_WAITS && status == GL_TIMEOUT_EXPIRED; ++i) {
+            status = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+        }
+        if (status == GL_TIMEOUT_EXPIRED) {
+            ++this->stats.numFenceTimeouts;
+        }
+        this->stats.stallTime += std::chrono::steady_clock::now() - stallStart;
+    }
+    glDeleteSync(sync);
+    fence = nullptr;
+}
+
+void UniformRingBuffer::endFrame() {
+    assert(("Ring buffer frame not begun", this->isInFrame));
+    this->flush();
+    this->fences[this->frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    this->isInFrame = false;
+
+    ++this->stats.numFrames;
+    this->stats.maxFrameBytes = std::max(this->stats.maxFrameBytes, this->frameBytes);
+}
+
+void *UniformRingBuffer::allocate(std::size_t size, std::size_t *offset) {
+    assert(("Ring buffer frame not begun", this->isInFrame));
+
+    const auto frameStart = this->frame * this->frameSize;
+    const auto start = alignUp(this->head, this->alignment);
+    if (start + size > frameStart + this->frameSize) {
+        this->grow(start + size - frameStart);
+        return this->allocate(size, offset);
+    }
+    const auto frameEnd = frameStart + this->frameSize;
+
+    // The region is unused by the GPU, so mapping it needs no synchronization
+    if (!this->isPersistentlyMapped && !this->mappedData) {
+        glBindBuffer(GL_UNIFORM_BUFFER, this->buffer.get());
+        this->mappedData = static_cast<unsigned char *>(glMapBufferRange(
+            GL_UNIFORM_BUFFER, start, frameEnd - start,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT));
+        this->mappedOffset = start;
+    }
+
+    this->frameBytes += start + size - this->head;
+    this->head = start + size;
+    *offset = start - frameStart;
+    return this->mappedData + (start - this->mappedOffset);
+}
+
+void UniformRingBuffer::flush() {
+    if (this->isPersistentlyMapped || !this->mappedData) {
+        return;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, this->buffer.get());
+    glFlushMappedBufferRange(GL_UNIFORM_BUFFER, 0, this->head - this->mappedOffset);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    this->mappedData = nullptr;
+}
+
+void UniformRingBuffer::bindRange(unsigned int bindingIndex, std::size_t offset, std::size_t size) const {
+    assert(("Ring buffer frame not begun", this->isInFrame));
+    glBindBufferRange(GL_UNIFORM_BUFFER, bindingIndex, this->buffer.get(),
+                      this->frame * this->frameSize + offset, size);
+}
+
+void UniformRingBuffer::createStorage() {
+    this->buffer = BufferHandle::create();
+    this->mappedData = nullptr;
+    this->mappedOffset = 0;
+    this->isPersistentlyMapped = false;
+
+    const auto size = NUM_FRAMES * this->frameSize;
+    glBindBuffer(GL_UNIFORM_BUFFER, this->buffer.get());
+    if (const auto bufferStorage = getBufferStorage()) {
+        const auto flags = GL_MAP_WRITE_BIT | MAP_PERSISTENT_BIT | MAP_COHERENT_BIT;
+        bufferStorage(GL_UNIFORM_BUFFER, size, nullptr, flags);
+        this->mappedData = static_cast<unsigned char *>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags));
+        this->isPersistentlyMapped = this->mappedData != nullptr;
+    } else {
+        glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    }
+}
+
+// Moves to a buffer with regions of at least minFrameSize bytes and copies
+// what the frame wrote so far to the same offset within its new region.
+// Draws already issued keep reading the old buffer, which GL deletes once
+// they are done.
+void UniformRingBuffer::grow(std::size_t minFrameSize) {
+    this->flush();
+    if (this->isPersistentlyMapped) {
+        glBindBuffer(GL_UNIFORM_BUFFER, this->buffer.get());
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+    }
+
+    const auto oldBuffer = std::move(this->buffer);
+    const auto oldFrameStart = this->frame * this->frameSize;
+    const auto numFrameBytes = this->head - oldFrameStart;
+    while (this->frameSize < minFrameSize) {
+        this->frameSize *= 2;
+    }
+    this->createStorage();
+
+    const auto frameStart = this->frame * this->frameSize;
+    if (numFrameBytes > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, oldBuffer.get());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer.get());
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, oldFrameStart, frameStart, numFrameBytes);
+    }
+    this->head = frameStart + numFrameBytes;
+
+    // No draw has read the new buffer yet, so no region needs waiting for
+    for (auto &fence : this->fences) {
+        if (fence) {
+            glDeleteSync(static_cast<GLsync>(fence));
+            fence = nullptr;
+        }
+    }
+    ++this->stats.numGrowths;
+}
+
+} // namespace lgl
@@ -1,7 +1,19 @@
 #include <lgl/Vertex.h>
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
 #include <utility>
 
+#include <glad/glad.h>
+#include <glm/common.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/packing.hpp>
+#include <glm/vec4.hpp>
+
+#include <lgl/TransformBatch.h>
+
 namespace lgl {
 
 Vertex::Vertex(glm::vec3 position, glm::vec3 normal, glm::vec2 textureCoordinates) :
@@ -9,4 +21,154 @@ Vertex::Vertex(glm::vec3 position, glm::vec3 normal, glm::vec2 textureCoordinate
     normal(std::move(normal)),
     textureCoordinates(std::move(textureCoordinates)) {}
 
+std::size_t getVertexSize(VertexFormat vertexFormat) {
+    switch (vertexFormat) {
+    case VertexFormat::Compact: return sizeof(CompactVertex);
+    default: return sizeof(Vertex);
+    }
+}
+
+std::vector<CompactVertex> compressVertices(const std::vector<Vertex> &vertices,
+                                            const glm::vec3 &positionScale,
+                                            const glm::vec3 &positionOffset) {
+    const auto maxPosition = static_cast<float>(std::numeric_limits<std::uint16_t>::max());
+
+    std::vector<CompactVertex> compactVertices(vertices.size());
+    std::transform(vertices.cbegin(), vertices.cend(), compactVertices.begin(),
+                   [&positionScale, &positionOffset, maxPosition](const auto &v){
+        CompactVertex compactVertex;
+        for (auto i = 0; i < 3; ++i) {
+            const auto normalizedPosition = positionScale[i] > 0.0f ?
+                        (v.position[i] - positionOffset[i]) / positionScale[i] : 0.0f;
+            compactVertex.position[i] = static_cast<std::uint16_t>(
+                        std::round(glm::clamp(normalizedPosition, 0.0f, 1.0f) * maxPosition));
+        }
+        compactVertex.padding = 0u;
+        compactVertex.normal = glm::packSnorm3x10_1x2(glm::vec4(v.normal, 0.0f));
+        compactVertex.textureCoordinates = glm::packHalf2x16(v.textureCoordinates);
+        return compactVertex;
+    });
+    return compactVertices;
+}
+
+std::vector<glm::vec3> getPositionStream(const std::vector<Vertex> &vertices) {
+    std::vector<glm::vec3> positions(vertices.size());
+    std::transform(vertices.cbegin(), vertices.cend(), positions.begin(),
+                   [](const auto &v){ return v.position; });
+    return positions;
+}
+
+std::vector<VertexAttributes> getAttributeStream(const std::vector<Vertex> &vertices) {
+    std::vector<VertexAttributes> attributes(vertices.size());
+    std::transform(vertices.cbegin(), vertices.cend(), attributes.begin(),
+                   [](const auto &v){ return VertexAttributes{v.normal, v.textureCoordinates}; });
+    return attributes;
+}
+
+void setVertexAttributes(VertexFormat vertexFormat) {
+    assert(("Split vertices need one call per stream", vertexFormat != VertexFormat::Split));
+
+    switch (vertexFormat) {
+    case VertexFormat::Compact:
+        // Positions
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactVertex),
+                              reinterpret_cast<void *>(0));
+
+        // Normals
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(CompactVertex),
+                              reinterpret_cast<void *>(offsetof(CompactVertex, normal)));
+
+        // Texture coordinates
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(CompactVertex),
+                              reinterpret_cast<void *>(offsetof(CompactVertex, textureCoordinates)));
+        break;
+
+    default:
+        // Positions
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              reinterpret_cast<void *>(0));
+
+        // Normals
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              reinterpret_cast<void *>(offsetof(Vertex, normal)));
+
+        // Texture coordinates
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              reinterpret_cast<void *>(offsetof(Vertex, textureCoordinates)));
+        break;
+    }
+}
+
+void setPositionStreamAttributes() {
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3),
+                          reinterpret_cast<void *>(0));
+}
+
+void setAttributeStreamAttributes() {
+    // Normals
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VertexAttributes),
+                          reinterpret_cast<void *>(offsetof(VertexAttributes, normal)));
+
+    // Texture coordinates
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VertexAttributes),
+                          reinterpret_cast<void *>(offsetof(VertexAttributes, textureCoordinates)));
+}
+
+namespace {
+
+constexpr auto MODEL_LOCATION = 3u;
+constexpr auto NORMAL_LOCATION = 7u;
+
+} // namespace
+
+void setInstanceAttributes() {
+    for (auto column = 0u; column < 4; ++column) {
+        glEnableVertexAttribArray(MODEL_LOCATION + column);
+        glVertexAttribPointer(MODEL_LOCATION + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform),
+                              reinterpret_cast<void *>(offsetof(InstanceTransform, model) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(MODEL_LOCATION + column, 1);
+    }
+
+    for (auto column = 0u; column < 3; ++column) {
+        glEnableVertexAttribArray(NORMAL_LOCATION + column);
+        glVertexAttribPointer(NORMAL_LOCATION + column, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform),
+                              reinterpret_cast<void *>(offsetof(InstanceTransform, normal) + column * sizeof(glm::vec3)));
+        glVertexAttribDivisor(NORMAL_LOCATION + column, 1);
+    }
+}
+
+void disableInstanceAttributes() {
+    for (auto location = MODEL_LOCATION; location < NORMAL_LOCATION + 3; ++location) {
+        glDisableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 0);
+    }
+}
+
+namespace {
+
+constexpr auto DRAW_ID_LOCATION = 10u;
+
+} // namespace
+
+void setDrawIdAttribute(std::size_t firstDrawId) {
+    glEnableVertexAttribArray(DRAW_ID_LOCATION);
+    glVertexAttribIPointer(DRAW_ID_LOCATION, 1, GL_UNSIGNED_INT, sizeof(unsigned int),
+                           reinterpret_cast<void *>(firstDrawId * sizeof(unsigned int)));
+    glVertexAttribDivisor(DRAW_ID_LOCATION, 1);
+}
+
+void disableDrawIdAttribute() {
+    glDisableVertexAttribArray(DRAW_ID_LOCATION);
+    glVertexAttribDivisor(DRAW_ID_LOCATION, 0);
+}
+
 } // namespace
@@ -0,0 +1,130 @@
+#include <cstdlib>
+#include <vector>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <lgl/Archetype.h>
+#include <lgl/Components.h>
+
+#include "Check.h"
+
+namespace {
+
+using Store = lgl::Archetype<lgl::TransformComponent, lgl::VelocityComponent,
+                             lgl::BoundsComponent, lgl::RenderComponent>;
+
+// Enough entities for several chunks, the last one partial
+constexpr auto NUM_ENTITIES = 5 * Store::CHUNK_SIZE + 7;
+
+Store::EntityId createAt(Store &store, const glm::vec3 &position) {
+    lgl::TransformComponent transform;
+    transform.position = position;
+    lgl::BoundsComponent bounds;
+    bounds.local.min = glm::vec3(-0.5f);
+    bounds.local.max = glm::vec3(0.5f);
+    return store.create(transform, lgl::VelocityComponent(), bounds, lgl::RenderComponent{nullptr});
+}
+
+float getX(Store &store, Store::EntityId entity) {
+    return store.get<lgl::TransformComponent>(entity).position.x;
+}
+
+void testStableIds() {
+    Store store;
+    std::vector<Store::EntityId> entities;
+    for (auto i = 0; i < 5; ++i) {
+        entities.push_back(createAt(store, {static_cast<float>(i), 0.0f, 0.0f}));
+    }
+
+    // Swap-remove from the middle moves the last entity into the hole
+    store.destroy(entities[1]);
+    CHECK(!store.isAlive(entities[1]));
+    CHECK(store.getSize() == 4);
+    CHECK(store.getIndex(entities[4]) == 1);
+    CHECK(store.getEntity(1) == entities[4]);
+    for (const auto i : {0, 2, 3, 4}) {
+        CHECK(store.isAlive(entities[i]));
+        CHECK(getX(store, entities[i]) == i);
+    }
+
+    // Removing the element that is last in the arrays moves nothing
+    store.destroy(entities[3]);
+    CHECK(store.getSize() == 3);
+    for (const auto i : {0, 2, 4}) {
+        CHECK(getX(store, entities[i]) == i);
+        CHECK(store.getEntity(store.getIndex(entities[i])) == entities[i]);
+    }
+
+    // Ids of destroyed entities are reused, with the new components
+    const auto entity = createAt(store, {9.0f, 0.0f, 0.0f});
+    CHECK(entity == entities[1] || entity == entities[3]);
+    CHECK(getX(store, entity) == 9.0f);
+    for (const auto i : {0, 2, 4}) {
+        CHECK(getX(store, entities[i]) == i);
+    }
+
+    // Down to none and back
+    for (const auto e : {entities[0], entities[2], entities[4], entity}) {
+        store.destroy(e);
+    }
+    CHECK(store.getSize() == 0);
+    CHECK(getX(store, createAt(store, {1.0f, 0.0f, 0.0f})) == 1.0f);
+}
+
+void testParallelForEach() {
+    Store store;
+    for (auto i = 0u; i < NUM_ENTITIES; ++i) {
+        createAt(store, glm::vec3(0.0f));
+    }
+
+    store.parallelForEach<lgl::TransformComponent>([](lgl::TransformComponent &transform){
+        transform.position.x += 1.0f;
+    }, 4);
+
+    const auto &transforms = store.getArray<lgl::TransformComponent>();
+    CHECK(transforms.size() == NUM_ENTITIES);
+    for (const auto &transform : transforms) {
+        CHECK(transform.position.x == 1.0f);
+    }
+
+    // Systems go through parallelForEach as well
+    auto &velocity = store.get<lgl::VelocityComponent>(store.getEntity(0));
+    velocity.linear = {0.0f, 2.0f, 0.0f};
+    lgl::integrateVelocities(store, 0.5f);
+    CHECK(transforms[0].position.y == 1.0f);
+    CHECK(transforms[1].position.y == 0.0f);
+}
+
+void testCollectVisible() {
+    // Every third entity in front of a camera looking down -z, the rest behind
+    Store store;
+    std::vector<unsigned int> expected;
+    for (auto i = 0u; i < NUM_ENTITIES; ++i) {
+        const auto z = i % 3 == 0 ? -10.0f : 10.0f;
+        createAt(store, {0.0f, 0.0f, z});
+        if (i % 3 == 0) {
+            expected.push_back(i);
+        }
+    }
+
+    lgl::updateWorldBounds(store);
+    const lgl::Frustum frustum(glm::perspective(glm::half_pi<float>(), 1.0f, 0.1f, 100.0f));
+    std::vector<unsigned int> visibleIndices{42};
+    lgl::collectVisible(store, frustum, visibleIndices);
+    CHECK(visibleIndices == expected);
+
+    // Any GameObject pointer will do, as it is only compared
+    lgl::TransformBatch instances;
+    lgl::buildInstances(store, visibleIndices, nullptr, instances);
+    CHECK(instances.getSize() == expected.size());
+}
+
+} // namespace
+
+int main() {
+    testStableIds();
+    testParallelForEach();
+    testCollectVisible();
+    return check::getNumFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <iostream>
+
+// Minimal assertions for the tests, which are plain executables run by CTest.
+// A failed CHECK reports itself and makes main() return failure through
+// getNumFailures().
+namespace check {
+
+inline int &getNumFailures() {
+    static int numFailures = 0;
+    return numFailures;
+}
+
+} // namespace check
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+            ++check::getNumFailures(); \
+        } \
+    } while (false)
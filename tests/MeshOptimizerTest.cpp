@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <lgl/MeshOptimizer.h>
+#include <lgl/Vertex.h>
+
+#include "Check.h"
+
+namespace {
+
+using Triangle = std::array<unsigned int, 3>;
+
+// Triangle by the contents of its vertices, for passes that renumber them
+using VertexKey = std::array<float, 8>;
+using VertexTriangle = std::array<VertexKey, 3>;
+
+// Rotated so the smallest index comes first, which keeps the winding
+std::vector<Triangle> getSortedTriangles(const std::vector<unsigned int> &indices) {
+    std::vector<Triangle> triangles;
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        Triangle triangle{indices[i], indices[i + 1], indices[i + 2]};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+VertexKey getVertexKey(const lgl::Vertex &v) {
+    return {v.position.x, v.position.y, v.position.z,
+            v.normal.x, v.normal.y, v.normal.z,
+            v.textureCoordinates.x, v.textureCoordinates.y};
+}
+
+std::vector<VertexTriangle> getSortedTriangles(const std::vector<unsigned int> &indices,
+                                               const std::vector<lgl::Vertex> &vertices) {
+    std::vector<VertexTriangle> triangles;
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        VertexTriangle triangle{getVertexKey(vertices[indices[i]]),
+                                getVertexKey(vertices[indices[i + 1]]),
+                                getVertexKey(vertices[indices[i + 2]])};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// Whether vertices appear in indices in order of first use, each referenced
+bool isFirstUseOrder(const std::vector<unsigned int> &indices, std::size_t numVertices) {
+    auto numUsed = 0u;
+    for (const auto i : indices) {
+        if (i == numUsed) {
+            ++numUsed;
+        } else if (i > numUsed) {
+            return false;
+        }
+    }
+    return numUsed == numVertices;
+}
+
+bool isClose(const lgl::Vertex &a, const lgl::Vertex &b, float maxDifference) {
+    const auto keyA = getVertexKey(a);
+    const auto keyB = getVertexKey(b);
+    for (std::size_t i = 0; i < keyA.size(); ++i) {
+        if (std::abs(keyA[i] - keyB[i]) > maxDifference) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Grid of size x size quads whose triangles each have their own copies of the
+// vertices, every attribute of every copy jittered by less than half of
+// epsilon. gridIndices gives the grid vertex each copy stands for.
+void makeJitteredGrid(unsigned int size, float epsilon, std::vector<lgl::Vertex> &gridVertices,
+                      std::vector<lgl::Vertex> &vertices, std::vector<unsigned int> &gridIndices) {
+    // Attributes on multiples of epsilon, where quantizing rounds back to them
+    for (auto y = 0u; y <= size; ++y) {
+        for (auto x = 0u; x <= size; ++x) {
+            const auto normal = glm::normalize(glm::vec3(x, y, size));
+            gridVertices.emplace_back(epsilon * glm::vec3(25 * x, 25 * y, 0.0f),
+                                      epsilon * glm::round(normal / epsilon),
+                                      epsilon * glm::round(glm::vec2(x, y) / (epsilon * size)));
+        }
+    }
+
+    std::mt19937 random(30);
+    std::uniform_real_distribution<float> jitter(-0.4f * epsilon, 0.4f * epsilon);
+    for (auto y = 0u; y < size; ++y) {
+        for (auto x = 0u; x < size; ++x) {
+            const auto i = y * (size + 1) + x;
+            for (const auto g : {i, i + 1, i + size + 2, i, i + size + 2, i + size + 1}) {
+                auto vertex = gridVertices[g];
+                vertex.position += glm::vec3(jitter(random), jitter(random), jitter(random));
+                vertex.normal += glm::vec3(jitter(random), jitter(random), jitter(random));
+                vertex.textureCoordinates += glm::vec2(jitter(random), jitter(random));
+                vertices.push_back(vertex);
+                gridIndices.push_back(g);
+            }
+        }
+    }
+}
+
+void testWeldEpsilon() {
+    const auto epsilon = 0.01f;
+    std::vector<lgl::Vertex> gridVertices;
+    std::vector<lgl::Vertex> vertices;
+    std::vector<unsigned int> gridIndices;
+    makeJitteredGrid(8, epsilon, gridVertices, vertices, gridIndices);
+
+    // Exact welding keeps every jittered copy
+    auto exactVertices = vertices;
+    std::vector<unsigned int> exactIndices(vertices.size());
+    std::iota(exactIndices.begin(), exactIndices.end(), 0u);
+    CHECK(lgl::weldVertices(exactVertices, exactIndices) == 0);
+    CHECK(exactVertices.size() == vertices.size());
+
+    // Copies closer than epsilon merge into one vertex per grid vertex
+    auto weldedVertices = vertices;
+    std::vector<unsigned int> indices(vertices.size());
+    std::iota(indices.begin(), indices.end(), 0u);
+    const auto numWelded = lgl::weldVertices(weldedVertices, indices, epsilon);
+    CHECK(weldedVertices.size() == gridVertices.size());
+    CHECK(numWelded == vertices.size() - weldedVertices.size());
+
+    // Each index points at a copy of its grid vertex, the same one for all
+    // copies, so triangles are unchanged up to the jitter
+    std::vector<unsigned int> gridToWelded(gridVertices.size(), gridVertices.size());
+    CHECK(indices.size() == gridIndices.size());
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        const auto g = gridIndices[i];
+        CHECK(indices[i] < weldedVertices.size());
+        CHECK(isClose(weldedVertices[indices[i]], gridVertices[g], 0.5f * epsilon));
+        if (gridToWelded[g] == gridVertices.size()) {
+            gridToWelded[g] = indices[i];
+        }
+        CHECK(indices[i] == gridToWelded[g]);
+    }
+    std::sort(gridToWelded.begin(), gridToWelded.end());
+    CHECK(std::adjacent_find(gridToWelded.cbegin(), gridToWelded.cend()) == gridToWelded.cend());
+
+    // Copies just over epsilon apart in any one attribute stay separate
+    for (auto attribute = 0; attribute < 8; ++attribute) {
+        std::vector<lgl::Vertex> pair{gridVertices[10], gridVertices[10]};
+        float *values = nullptr;
+        switch (attribute / 3) {
+        case 0: values = &pair[1].position.x; break;
+        case 1: values = &pair[1].normal.x; break;
+        default: values = &pair[1].textureCoordinates.x; break;
+        }
+        values[attribute % 3] += 1.01f * epsilon;
+
+        std::vector<unsigned int> pairIndices{0, 1, 1, 0};
+        CHECK(lgl::weldVertices(pair, pairIndices, epsilon) == 0);
+        CHECK(pair.size() == 2);
+        CHECK((pairIndices == std::vector<unsigned int>{0, 1, 1, 0}));
+    }
+}
+
+void testMesh(const aiMesh &mesh, const std::string &name) {
+    std::vector<lgl::Vertex> vertices;
+    vertices.reserve(mesh.mNumVertices);
+    for (auto i = 0u; i < mesh.mNumVertices; ++i) {
+        const auto &p = mesh.mVertices[i];
+        const auto n = mesh.mNormals ? mesh.mNormals[i] : aiVector3D(0.0f);
+        const auto t = mesh.mTextureCoords[0] ? mesh.mTextureCoords[0][i] : aiVector3D(0.0f);
+        vertices.emplace_back(glm::vec3(p.x, p.y, p.z), glm::vec3(n.x, n.y, n.z), glm::vec2(t.x, t.y));
+    }
+
+    std::vector<unsigned int> indices;
+    for (auto i = 0u; i < mesh.mNumFaces; ++i) {
+        const auto &face = mesh.mFaces[i];
+        indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+    }
+
+    // As GameObject prepares meshes before optimizing them
+    lgl::weldVertices(vertices, indices);
+
+    const auto optimized = lgl::optimizeVertexCache(indices, vertices.size());
+    const auto before = lgl::analyzeVertexCache(indices, vertices.size());
+    const auto after = lgl::analyzeVertexCache(optimized, vertices.size());
+    std::cout << name << ": " << indices.size() / 3 << " triangles, ACMR "
+              << before.getACMR() << " -> " << after.getACMR() << "\n";
+
+    CHECK(after.getACMR() <= before.getACMR());
+    CHECK(after.getATVR() <= before.getATVR());
+    CHECK(optimized.size() == indices.size());
+    CHECK(getSortedTriangles(optimized) == getSortedTriangles(indices));
+
+    // Overdraw ordering may give back up to its threshold of the cache gains
+    const auto overdrawOptimized = lgl::optimizeOverdraw(optimized, vertices);
+    const auto overdraw = lgl::analyzeVertexCache(overdrawOptimized, vertices.size());
+    CHECK(overdraw.getACMR() <= after.getACMR() * lgl::DEFAULT_OVERDRAW_THRESHOLD);
+    CHECK(getSortedTriangles(overdrawOptimized) == getSortedTriangles(indices));
+
+    // The whole pipeline, as GameObject runs it, renumbers the vertices too
+    auto meshVertices = vertices;
+    auto meshIndices = indices;
+    const auto stats = lgl::optimizeMesh(meshVertices, meshIndices);
+    std::cout << name << ": optimizeMesh ACMR " << stats.before.getACMR() << " -> " << stats.after.getACMR()
+              << ", ATVR " << stats.before.getATVR() << " -> " << stats.after.getATVR() << "\n";
+
+    CHECK(stats.after.getACMR() <= stats.before.getACMR());
+    CHECK(stats.after.getATVR() <= stats.before.getATVR());
+    CHECK(meshIndices.size() == indices.size());
+    CHECK(isFirstUseOrder(meshIndices, meshVertices.size()));
+    CHECK(getSortedTriangles(meshIndices, meshVertices) == getSortedTriangles(indices, vertices));
+}
+
+} // namespace
+
+// Arguments are the model files to test
+int main(int argc, char *argv[]) {
+    CHECK(argc > 1);
+
+    testWeldEpsilon();
+
+    for (auto i = 1; i < argc; ++i) {
+        Assimp::Importer importer;
+        const auto scene = importer.ReadFile(argv[i], aiProcess_Triangulate);
+        CHECK(scene != nullptr);
+        if (!scene) {
+            continue;
+        }
+
+        for (auto m = 0u; m < scene->mNumMeshes; ++m) {
+            const auto &mesh = *scene->mMeshes[m];
+            if (mesh.mPrimitiveTypes == aiPrimitiveType_TRIANGLE) {
+                testMesh(mesh, std::string(argv[i]) + ":" + mesh.mName.C_Str());
+            }
+        }
+    }
+
+    return check::getNumFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
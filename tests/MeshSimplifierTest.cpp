@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include <glm/geometric.hpp>
+
+#include <lgl/MeshOptimizer.h>
+#include <lgl/MeshSimplifier.h>
+#include <lgl/Vertex.h>
+
+#include "Check.h"
+
+namespace {
+
+using Position = std::array<float, 3>;
+
+Position getPosition(const lgl::Vertex &v) {
+    return {v.position.x, v.position.y, v.position.z};
+}
+
+// Positions on edges that only one triangle uses in its direction, as the
+// simplifier finds open borders
+std::set<Position> getBorderPositions(const std::vector<unsigned int> &indices,
+                                      const std::vector<lgl::Vertex> &vertices) {
+    std::set<std::array<Position, 2>> edges;
+    for (std::size_t i = 0; i < indices.size(); i += 3) {
+        for (auto k = 0u; k < 3; ++k) {
+            edges.insert({getPosition(vertices[indices[i + k]]), getPosition(vertices[indices[i + (k + 1) % 3]])});
+        }
+    }
+
+    std::set<Position> borderPositions;
+    for (const auto &edge : edges) {
+        if (edges.count({edge[1], edge[0]}) == 0) {
+            borderPositions.insert(edge[0]);
+            borderPositions.insert(edge[1]);
+        }
+    }
+    return borderPositions;
+}
+
+std::set<Position> getUsedPositions(const std::vector<unsigned int> &indices,
+                                    const std::vector<lgl::Vertex> &vertices) {
+    std::set<Position> positions;
+    for (const auto i : indices) {
+        positions.insert(getPosition(vertices[i]));
+    }
+    return positions;
+}
+
+bool isValid(const std::vector<unsigned int> &indices, std::size_t numVertices) {
+    if (indices.size() % 3 != 0) {
+        return false;
+    }
+    for (std::size_t i = 0; i < indices.size(); i += 3) {
+        const auto a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (a >= numVertices || b >= numVertices || c >= numVertices || a == b || b == c || c == a) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testMesh(const aiMesh &mesh, const std::string &name) {
+    std::vector<lgl::Vertex> vertices;
+    vertices.reserve(mesh.mNumVertices);
+    for (auto i = 0u; i < mesh.mNumVertices; ++i) {
+        const auto &p = mesh.mVertices[i];
+        const auto n = mesh.mNormals ? mesh.mNormals[i] : aiVector3D(0.0f);
+        const auto t = mesh.mTextureCoords[0] ? mesh.mTextureCoords[0][i] : aiVector3D(0.0f);
+        vertices.emplace_back(glm::vec3(p.x, p.y, p.z), glm::vec3(n.x, n.y, n.z), glm::vec2(t.x, t.y));
+    }
+
+    std::vector<unsigned int> indices;
+    for (auto i = 0u; i < mesh.mNumFaces; ++i) {
+        const auto &face = mesh.mFaces[i];
+        indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+    }
+
+    // As GameObject prepares meshes before simplifying them
+    lgl::weldVertices(vertices, indices);
+    lgl::optimizeMesh(vertices, indices);
+
+    lgl::LodSettings settings;
+    settings.maxNumLods = 4;
+    const auto lods = lgl::generateLods(vertices, indices, settings);
+    std::cout << name << ": " << indices.size() / 3 << " triangles";
+    for (const auto &lod : lods) {
+        std::cout << " -> " << lod.indices.size() / 3 << " (error " << lod.error << ")";
+    }
+    std::cout << "\n";
+
+    const auto borderPositions = getBorderPositions(indices, vertices);
+    auto previousNumIndices = indices.size();
+    auto previousError = 0.0f;
+    for (const auto &lod : lods) {
+        CHECK(lod.indices.size() <= 0.9f * previousNumIndices);
+        CHECK(lod.error >= previousError);
+        CHECK(isValid(lod.indices, vertices.size()));
+
+        // Vertices never move, so a kept border keeps its positions
+        const auto usedPositions = getUsedPositions(lod.indices, vertices);
+        CHECK(std::includes(usedPositions.cbegin(), usedPositions.cend(),
+                            borderPositions.cbegin(), borderPositions.cend()));
+
+        previousNumIndices = lod.indices.size();
+        previousError = lod.error;
+    }
+}
+
+// Flat square of size x size quads in the xy plane facing +z
+void makeGrid(unsigned int size, std::vector<lgl::Vertex> &vertices, std::vector<unsigned int> &indices) {
+    for (auto y = 0u; y <= size; ++y) {
+        for (auto x = 0u; x <= size; ++x) {
+            vertices.emplace_back(glm::vec3(x, y, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f),
+                                  glm::vec2(x, y) / static_cast<float>(size));
+        }
+    }
+    for (auto y = 0u; y < size; ++y) {
+        for (auto x = 0u; x < size; ++x) {
+            const auto i = y * (size + 1) + x;
+            indices.insert(indices.end(), {i, i + 1, i + size + 2, i, i + size + 2, i + size + 1});
+        }
+    }
+}
+
+// A plane simplifies without error, keeps its border and never turns a
+// triangle over
+void testGrid() {
+    std::vector<lgl::Vertex> vertices;
+    std::vector<unsigned int> indices;
+    makeGrid(16, vertices, indices);
+
+    float error = -1.0f;
+    const auto simplified = lgl::simplifyMesh(vertices, indices, indices.size() / 4, &error);
+    CHECK(simplified.size() < indices.size());
+    CHECK(error >= 0.0f && error < 1e-4f);
+    CHECK(isValid(simplified, vertices.size()));
+
+    const auto borderPositions = getBorderPositions(indices, vertices);
+    const auto usedPositions = getUsedPositions(simplified, vertices);
+    CHECK(std::includes(usedPositions.cbegin(), usedPositions.cend(),
+                        borderPositions.cbegin(), borderPositions.cend()));
+    CHECK(getBorderPositions(simplified, vertices) == borderPositions);
+
+    for (std::size_t i = 0; i < simplified.size(); i += 3) {
+        const auto &p0 = vertices[simplified[i]].position;
+        const auto &p1 = vertices[simplified[i + 1]].position;
+        const auto &p2 = vertices[simplified[i + 2]].position;
+        CHECK(glm::cross(p1 - p0, p2 - p0).z > 0.0f);
+    }
+}
+
+// Errors at scale 1 of four levels, with a maximum error of 1
+void testLodHysteresis() {
+    const std::vector<float> errors{0.0f, 1.0f, 2.0f, 4.0f};
+    const auto select = [&errors](std::size_t currentLod, float errorScale){
+        return lgl::selectLod(errors.size(), currentLod, 1.0f,
+                              [&errors, errorScale](std::size_t lod){ return errors[lod] * errorScale; });
+    };
+
+    // Coarser once its error is clearly below the maximum, only as far as that holds
+    auto lod = select(0, 0.7f);
+    CHECK(lod == 1);
+    CHECK(select(0, 0.3f) == 2);
+
+    // Errors wandering within the band around the maximum change nothing
+    for (const auto errorScale : {0.8f, 1.2f, 0.9f, 1.1f, 0.76f, 1.24f}) {
+        lod = select(lod, errorScale);
+        CHECK(lod == 1);
+    }
+
+    // Finer once the error clearly exceeds it, and then again no flicker
+    lod = select(lod, 1.3f);
+    CHECK(lod == 0);
+    for (const auto errorScale : {0.8f, 1.2f, 0.9f, 1.1f, 0.76f, 1.24f}) {
+        lod = select(lod, errorScale);
+        CHECK(lod == 0);
+    }
+}
+
+} // namespace
+
+// Arguments are the model files to test
+int main(int argc, char *argv[]) {
+    CHECK(argc > 1);
+
+    testGrid();
+    testLodHysteresis();
+
+    for (auto i = 1; i < argc; ++i) {
+        Assimp::Importer importer;
+        const auto scene = importer.ReadFile(argv[i], aiProcess_Triangulate);
+        CHECK(scene != nullptr);
+        if (!scene) {
+            continue;
+        }
+
+        for (auto m = 0u; m < scene->mNumMeshes; ++m) {
+            const auto &mesh = *scene->mMeshes[m];
+            if (mesh.mPrimitiveTypes == aiPrimitiveType_TRIANGLE) {
+                testMesh(mesh, std::string(argv[i]) + ":" + mesh.mName.C_Str());
+            }
+        }
+    }
+
+    return check::getNumFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
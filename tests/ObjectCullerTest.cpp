@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <lgl/ObjectCuller.h>
+
+#include "Check.h"
+
+namespace {
+
+// Unit box that moves like a game object, without any meshes to load
+class TestObject {
+public:
+    explicit TestObject(const glm::vec3 &position) { this->setPosition(position); }
+
+    const lgl::Aabb &getWorldBounds() const { return this->bounds; }
+    unsigned long getTransformVersion() const { return this->version; }
+
+    void setPosition(const glm::vec3 &position) {
+        this->bounds.min = position - glm::vec3(0.5f);
+        this->bounds.max = position + glm::vec3(0.5f);
+        ++this->version;
+    }
+
+private:
+    lgl::Aabb bounds;
+    unsigned long version = 0;
+};
+
+using ObjectCuller = lgl::BasicObjectCuller<TestObject>;
+
+// Camera at the origin looking down -z, near plane at 0.1 and far plane at 100
+lgl::Frustum getFrustum() {
+    return lgl::Frustum(glm::perspective(glm::half_pi<float>(), 1.0f, 0.1f, 100.0f));
+}
+
+bool contains(const std::vector<TestObject *> &objects, const TestObject *object) {
+    return std::find(objects.cbegin(), objects.cend(), object) != objects.cend();
+}
+
+void testRefit() {
+    TestObject inView({0.0f, 0.0f, -10.0f});
+    TestObject behind({0.0f, 0.0f, 10.0f});
+
+    ObjectCuller culler;
+    culler.add(&inView);
+    culler.add(&behind);
+
+    auto visible = culler.cull(getFrustum());
+    CHECK(visible.size() == 1);
+    CHECK(contains(visible, &inView));
+
+    // Moves far beyond the tree's margin are picked up by the next cull
+    inView.setPosition({0.0f, 0.0f, 50.0f});
+    behind.setPosition({0.0f, 0.0f, -50.0f});
+    visible = culler.cull(getFrustum());
+    CHECK(visible.size() == 1);
+    CHECK(contains(visible, &behind));
+
+    // So are moves within it
+    behind.setPosition({0.0f, 0.0f, -50.05f});
+    CHECK(culler.cull(getFrustum()).size() == 1);
+
+    culler.remove(&behind);
+    CHECK(culler.getNumObjects() == 1);
+    CHECK(culler.cull(getFrustum()).empty());
+
+    inView.setPosition({0.0f, 0.0f, -5.0f});
+    visible = culler.cull(getFrustum());
+    CHECK(visible.size() == 1);
+    CHECK(contains(visible, &inView));
+}
+
+// The tree returns the objects testing every box would, plus at most those
+// that only its enlarged boxes reach
+void testVisibleSet() {
+    // Twice the tree's margin, as fat boxes may lag behind moves within it
+    const auto maxFatMargin = 0.2f;
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+    const auto getRandomPosition = [&]{
+        return glm::vec3(coordinate(generator), coordinate(generator), coordinate(generator));
+    };
+
+    std::vector<TestObject> objects;
+    for (auto i = 0; i < 1000; ++i) {
+        objects.emplace_back(getRandomPosition());
+    }
+
+    ObjectCuller culler;
+    for (auto &object : objects) {
+        culler.add(&object);
+    }
+
+    const auto frustum = getFrustum();
+    for (auto frame = 0; frame < 4; ++frame) {
+        const auto &visible = culler.cull(frustum);
+        CHECK(culler.getStats().numVisible == visible.size());
+        CHECK(!visible.empty());
+
+        for (auto &object : objects) {
+            if (frustum.testBox(object.getWorldBounds()) != lgl::Frustum::Containment::Outside) {
+                CHECK(contains(visible, &object));
+            } else if (contains(visible, &object)) {
+                CHECK(frustum.testBox(lgl::inflate(object.getWorldBounds(), maxFatMargin)) !=
+                      lgl::Frustum::Containment::Outside);
+            }
+        }
+
+        // Move a tenth of the objects before the next frame
+        for (auto i = 0u; i < objects.size(); i += 10) {
+            objects[i].setPosition(getRandomPosition());
+        }
+    }
+
+    for (auto i = 0u; i < objects.size(); i += 2) {
+        culler.remove(&objects[i]);
+    }
+    for (const auto *object : culler.cull(frustum)) {
+        CHECK((object - objects.data()) % 2 == 1);
+    }
+}
+
+} // namespace
+
+int main() {
+    testRefit();
+    testVisibleSet();
+    return check::getNumFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
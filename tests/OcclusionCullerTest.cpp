@@ -0,0 +1,88 @@
+#include <cstdlib>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <lgl/OcclusionCuller.h>
+
+#include "Check.h"
+
+namespace {
+
+lgl::Aabb createBox(const glm::vec3 &min, const glm::vec3 &max) {
+    lgl::Aabb box;
+    box.min = min;
+    box.max = max;
+    return box;
+}
+
+// Closed box, counter clockwise when seen from outside
+lgl::OccluderMesh createBoxOccluder(const lgl::Aabb &box) {
+    lgl::OccluderMesh occluder;
+    for (auto k = 0; k < 8; ++k) {
+        occluder.positions.emplace_back(k & 1 ? box.max.x : box.min.x,
+                                        k & 2 ? box.max.y : box.min.y,
+                                        k & 4 ? box.max.z : box.min.z);
+    }
+    occluder.indices = {
+        0, 2, 3, 0, 3, 1,   // -z
+        4, 5, 7, 4, 7, 6,   // +z
+        0, 1, 5, 0, 5, 4,   // -y
+        2, 6, 7, 2, 7, 3,   // +y
+        0, 4, 6, 0, 6, 2,   // -x
+        1, 3, 7, 1, 7, 5,   // +x
+    };
+    return occluder;
+}
+
+// Camera at the origin looking down -z, near plane at 0.1 and far plane at 100
+lgl::OcclusionCuller beginFrame(const lgl::OccluderMesh &occluder) {
+    lgl::OcclusionCuller culler;
+    culler.beginFrame(glm::perspective(glm::half_pi<float>(), 2.0f, 0.1f, 100.0f));
+    culler.addOccluder(occluder, glm::mat4(1.0f));
+    culler.rasterize();
+    return culler;
+}
+
+void testWall() {
+    // A wall 10 units away, covering the center of the view
+    auto culler = beginFrame(createBoxOccluder(createBox({-5.0f, -5.0f, -12.0f}, {5.0f, 5.0f, -10.0f})));
+    CHECK(culler.getStats().numOccluderTriangles > 0);
+
+    // Fully hidden
+    CHECK(!culler.isVisible(createBox({-1.0f, -1.0f, -20.0f}, {1.0f, 1.0f, -18.0f})));
+
+    // Partly hidden, sticking out to the right of the wall
+    CHECK(culler.isVisible(createBox({4.0f, -1.0f, -20.0f}, {14.0f, 1.0f, -18.0f})));
+
+    // In front of the wall
+    CHECK(culler.isVisible(createBox({-1.0f, -1.0f, -5.0f}, {1.0f, 1.0f, -4.0f})));
+
+    // Beside the wall but behind the far plane
+    CHECK(!culler.isVisible(createBox({30.0f, -1.0f, -200.0f}, {32.0f, 1.0f, -190.0f})));
+
+    // Crossing the near plane in front of the wall
+    CHECK(culler.isVisible(createBox({-0.01f, -0.01f, -0.5f}, {0.01f, 0.01f, -0.05f})));
+
+    CHECK(culler.getStats().numTested == 5);
+    CHECK(culler.getStats().numOccluded == 2);
+}
+
+void testOccluderCrossingNearPlane() {
+    // A quad tilted away from the camera whose lower part lies in front of
+    // the near plane, where it would be clipped away when drawn, so it must
+    // not hide what is behind that part
+    lgl::OccluderMesh occluder;
+    occluder.positions = {{-0.04f, -0.04f, -0.05f}, {0.04f, -0.04f, -0.05f}, {0.5f, 0.5f, -1.0f}, {-0.5f, 0.5f, -1.0f}};
+    occluder.indices = {0, 1, 2, 0, 2, 3};
+    auto culler = beginFrame(occluder);
+    CHECK(culler.isVisible(createBox({-1.0f, -10.0f, -20.0f}, {1.0f, -8.0f, -18.0f})));
+}
+
+} // namespace
+
+int main() {
+    testWall();
+    testOccluderCrossingNearPlane();
+    return check::getNumFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+#include <lgl/RangeAllocator.h>
+
+#include "Check.h"
+
+namespace lgl {
+
+// Where argument dependent lookup finds it when comparing free ranges
+bool operator==(const RangeAllocator::Range &a, const RangeAllocator::Range &b) {
+    return a.offset == b.offset && a.size == b.size;
+}
+
+} // namespace lgl
+
+namespace {
+
+using Range = lgl::RangeAllocator::Range;
+
+Range allocate(lgl::RangeAllocator &allocator, std::size_t size) {
+    Range range{~std::size_t(0), size};
+    CHECK(allocator.allocate(size, &range.offset));
+    return range;
+}
+
+void testAllocateFreeReallocate() {
+    lgl::RangeAllocator allocator(100);
+    CHECK(allocator.getNumFree() == 100);
+
+    // First fit packs allocations back to back
+    const auto a = allocate(allocator, 10);
+    const auto b = allocate(allocator, 20);
+    const auto c = allocate(allocator, 30);
+    const auto d = allocate(allocator, 40);
+    CHECK(a.offset == 0 && b.offset == 10 && c.offset == 30 && d.offset == 60);
+    CHECK(allocator.getNumFree() == 0);
+    CHECK(allocator.getFreeRanges().empty());
+
+    std::size_t offset = 0;
+    CHECK(!allocator.allocate(1, &offset));
+
+    // Out of order, leaving free ranges sorted by offset
+    allocator.free(c);
+    allocator.free(a);
+    CHECK(allocator.getNumFree() == 40);
+    CHECK((allocator.getFreeRanges() == std::vector<Range>{a, c}));
+
+    // Too large for either, then fitting the first and then the remainder of
+    // the second
+    CHECK(!allocator.allocate(31, &offset));
+    CHECK(allocate(allocator, 5).offset == 0);
+    CHECK(allocate(allocator, 25).offset == 30);
+    CHECK(allocate(allocator, 5).offset == 5);
+    CHECK((allocator.getFreeRanges() == std::vector<Range>{{55, 5}}));
+
+    // Empty ranges take up nothing
+    CHECK(allocate(allocator, 0).offset == 0);
+    allocator.free({0, 0});
+    CHECK(allocator.getNumFree() == 5);
+}
+
+void testMergeAdjacent() {
+    lgl::RangeAllocator allocator(50);
+    std::vector<Range> ranges;
+    for (auto i = 0; i < 5; ++i) {
+        ranges.push_back(allocate(allocator, 10));
+    }
+
+    // Merging with the previous range, the next range and both
+    allocator.free(ranges[1]);
+    allocator.free(ranges[2]);
+    CHECK((allocator.getFreeRanges() == std::vector<Range>{{10, 20}}));
+    allocator.free(ranges[4]);
+    allocator.free(ranges[3]);
+    CHECK((allocator.getFreeRanges() == std::vector<Range>{{10, 40}}));
+    allocator.free(ranges[0]);
+    CHECK((allocator.getFreeRanges() == std::vector<Range>{{0, 50}}));
+
+    // So that the whole capacity fits again
+    CHECK(allocate(allocator, 50).offset == 0);
+}
+
+// GeometryPool only grows its buffers when allocate() fails
+void testReuseBeforeGrow() {
+    lgl::RangeAllocator allocator(64);
+    const auto a = allocate(allocator, 16);
+    allocate(allocator, 48);
+
+    allocator.free(a);
+    std::size_t offset = 0;
+    CHECK(allocator.allocate(16, &offset));
+    CHECK(offset == a.offset);
+    CHECK(allocator.getCapacity() == 64);
+
+    // Only once full does it take grown space, which merges with a free
+    // range at the old end
+    CHECK(!allocator.allocate(8, &offset));
+    allocator.grow(128);
+    CHECK(allocator.getCapacity() == 128);
+    CHECK(allocate(allocator, 64).offset == 64);
+
+    allocator.free({100, 28});
+    allocator.grow(256);
+    CHECK((allocator.getFreeRanges() == std::vector<Range>{{100, 156}}));
+
+    // As after defragmenting, with everything in use moved to the front
+    allocator.reset(40);
+    CHECK((allocator.getFreeRanges() == std::vector<Range>{{40, 216}}));
+    CHECK(allocator.getNumFree() == 216);
+}
+
+} // namespace
+
+int main() {
+    testAllocateFreeReallocate();
+    testMergeAdjacent();
+    testReuseBeforeGrow();
+    return check::getNumFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
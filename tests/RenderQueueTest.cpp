@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <lgl/RenderQueue.h>
+
+#include "Check.h"
+
+namespace {
+
+// Draws are identified by the x translation of their model matrix. Packets
+// keyed directly need no shader program or mesh, so nothing touches GL.
+struct Draw {
+    std::uint64_t key;
+    int id;
+};
+
+constexpr int NUM_KEYS = 7;
+
+void submit(lgl::CommandList &commandList, const Draw &draw) {
+    glm::mat4 model(1.0f);
+    model[3][0] = static_cast<float>(draw.id);
+    commandList.submit(draw.key, nullptr, nullptr, model, glm::mat3(1.0f));
+}
+
+// Few keys, so that most draws tie and their order is up to the merge
+Draw getDraw(int id) {
+    return {static_cast<std::uint64_t>((id * 5) % NUM_KEYS), id};
+}
+
+std::vector<int> getSortedIds(lgl::RenderQueue &renderQueue) {
+    std::vector<int> ids;
+    for (const auto packet : renderQueue.getSortedPackets()) {
+        ids.push_back(static_cast<int>(packet->uniforms->model[3][0]));
+    }
+    return ids;
+}
+
+// Submission order, sorted stably by key
+std::vector<int> getExpectedIds(std::vector<Draw> draws) {
+    std::stable_sort(draws.begin(), draws.end(), [](const Draw &a, const Draw &b){ return a.key < b.key; });
+
+    std::vector<int> ids;
+    for (const auto &draw : draws) {
+        ids.push_back(draw.id);
+    }
+    return ids;
+}
+
+void testMergedOrder() {
+    lgl::RenderQueue renderQueue;
+    std::vector<Draw> draws;
+    auto nextId = 0;
+
+    // The queue's own list comes before recorded lists
+    for (auto i = 0; i < 20; ++i) {
+        draws.push_back(getDraw(nextId++));
+        submit(renderQueue.getCommandList(), draws.back());
+    }
+
+    // Chunks of one draw each, and uneven chunks of a second record() call
+    // that come after all chunks of the first
+    for (const auto chunkSize : {1, 16}) {
+        const auto firstId = nextId;
+        const auto count = 1000;
+        for (auto i = 0; i < count; ++i) {
+            draws.push_back(getDraw(nextId++));
+        }
+        renderQueue.record(count, chunkSize, [firstId](lgl::CommandList &commandList, std::size_t begin,
+                                                        std::size_t end){
+            for (auto i = begin; i < end; ++i) {
+                submit(commandList, getDraw(firstId + static_cast<int>(i)));
+            }
+        }, 4);
+    }
+
+    CHECK(renderQueue.getSize() == draws.size());
+    const auto expectedIds = getExpectedIds(draws);
+    CHECK(getSortedIds(renderQueue) == expectedIds);
+
+    // Lists are reused by the next frame and don't hold on to old draws
+    renderQueue.clear();
+    CHECK(renderQueue.getSize() == 0);
+    CHECK(renderQueue.getSortedPackets().empty());
+
+    renderQueue.record(draws.size(), 3, [&draws](lgl::CommandList &commandList, std::size_t begin,
+                                                 std::size_t end){
+        for (auto i = begin; i < end; ++i) {
+            submit(commandList, draws[i]);
+        }
+    }, 4);
+    CHECK(getSortedIds(renderQueue) == expectedIds);
+}
+
+} // namespace
+
+int main() {
+    testMergedOrder();
+    return check::getNumFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
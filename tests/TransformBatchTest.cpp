@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <lgl/Frame.h>
+#include <lgl/TransformBatch.h>
+
+#include "Check.h"
+
+namespace {
+
+// Relative to the magnitude of the expected value, since inverse scales grow large
+bool isClose(float actual, float expected) {
+    return std::abs(actual - expected) <= 1e-4f * std::max(1.0f, std::abs(expected));
+}
+
+bool isClose(const glm::mat4 &actual, const glm::mat4 &expected) {
+    for (auto column = 0; column < 4; ++column) {
+        for (auto row = 0; row < 4; ++row) {
+            if (!isClose(actual[column][row], expected[column][row])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool isClose(const glm::mat3 &actual, const glm::mat3 &expected) {
+    return isClose(glm::mat4(actual), glm::mat4(expected));
+}
+
+// Moved, rotated about a random axis and scaled differently along each axis
+std::vector<lgl::Frame> getRandomFrames(std::size_t count, std::mt19937 &random) {
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> angle(-glm::pi<float>(), glm::pi<float>());
+    std::uniform_real_distribution<float> scale(0.1f, 4.0f);
+
+    std::vector<lgl::Frame> frames(count);
+    for (auto &frame : frames) {
+        frame.setPosition({position(random), position(random), position(random)});
+        const glm::vec3 axis(position(random), position(random), position(random) + 0.1f);
+        frame.rotate(angle(random), glm::normalize(axis));
+        frame.setScale({scale(random), scale(random), scale(random)});
+    }
+    return frames;
+}
+
+// Counts below, at and above the four transforms the SSE path does at once
+void testComputeTransforms() {
+    std::mt19937 random(39);
+    for (const auto count : {1u, 3u, 4u, 5u, 1027u}) {
+        const auto frames = getRandomFrames(count, random);
+        lgl::TransformBatch batch;
+        for (const auto &frame : frames) {
+            batch.add(frame);
+        }
+
+        std::vector<lgl::InstanceTransform> output(count);
+        batch.computeTransforms(output.data());
+        for (auto i = 0u; i < count; ++i) {
+            const auto model = frames[i].getModelMatrix();
+            CHECK(isClose(output[i].model, model));
+            CHECK(isClose(output[i].normal, frames[i].getNormalMatrix()));
+            CHECK(isClose(output[i].normal, glm::inverseTranspose(glm::mat3(model))));
+        }
+    }
+}
+
+// writeInstanceBuffer() computes straight into the mapped buffer, which the
+// instance attributes read at the offsets of InstanceTransform with no gaps
+// between instances. Check each instance fills exactly its own bytes.
+void testInstanceBufferLayout() {
+    static_assert(sizeof(lgl::InstanceTransform) == (16 + 9) * sizeof(float),
+                  "Instance attributes expect tightly packed transforms");
+    static_assert(offsetof(lgl::InstanceTransform, normal) == 16 * sizeof(float),
+                  "Normal columns follow the model columns");
+
+    std::mt19937 random(40);
+    const auto count = 7u;
+    const auto frames = getRandomFrames(count, random);
+    lgl::TransformBatch batch;
+    for (const auto &frame : frames) {
+        batch.add(frame);
+    }
+
+    // One more instance than computed, which must stay untouched
+    const auto sentinel = 12345.0f;
+    const auto numFloats = sizeof(lgl::InstanceTransform) / sizeof(float);
+    std::vector<float> buffer((count + 1) * numFloats, sentinel);
+    batch.computeTransforms(reinterpret_cast<lgl::InstanceTransform *>(buffer.data()));
+
+    for (auto i = 0u; i < count; ++i) {
+        const auto *instance = buffer.data() + i * numFloats;
+        const auto model = frames[i].getModelMatrix();
+        const auto normal = frames[i].getNormalMatrix();
+        for (auto column = 0; column < 4; ++column) {
+            for (auto row = 0; row < 4; ++row) {
+                CHECK(isClose(instance[column * 4 + row], model[column][row]));
+            }
+        }
+        for (auto column = 0; column < 3; ++column) {
+            for (auto row = 0; row < 3; ++row) {
+                CHECK(isClose(instance[16 + column * 3 + row], normal[column][row]));
+            }
+        }
+    }
+    CHECK(std::all_of(buffer.cbegin() + count * numFloats, buffer.cend(),
+                      [sentinel](float f){ return f == sentinel; }));
+}
+
+// Changing one object after computing gives the same as computing afresh
+void testSetAfterAdd() {
+    std::mt19937 random(41);
+    auto frames = getRandomFrames(6, random);
+    lgl::TransformBatch batch;
+    for (const auto &frame : frames) {
+        batch.add(frame);
+    }
+
+    frames[5] = getRandomFrames(1, random)[0];
+    batch.set(5, frames[5]);
+
+    std::vector<lgl::InstanceTransform> output(frames.size());
+    batch.computeTransforms(output.data());
+    CHECK(isClose(output[5].model, frames[5].getModelMatrix()));
+    CHECK(isClose(output[5].normal, frames[5].getNormalMatrix()));
+}
+
+} // namespace
+
+int main() {
+    testComputeTransforms();
+    testInstanceBufferLayout();
+    testSetAfterAdd();
+    return check::getNumFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
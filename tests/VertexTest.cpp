@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/packing.hpp>
+#include <glm/vec4.hpp>
+
+#include <lgl/Aabb.h>
+#include <lgl/Vertex.h>
+
+#include "Check.h"
+
+namespace {
+
+// As the vertex shader with COMPACT_VERTICES sees a CompactVertex
+lgl::Vertex decompress(const lgl::CompactVertex &v, const glm::vec3 &positionScale,
+                       const glm::vec3 &positionOffset) {
+    const glm::vec3 normalizedPosition(v.position[0], v.position[1], v.position[2]);
+    return {positionOffset + positionScale * normalizedPosition / 65535.0f,
+            glm::vec3(glm::unpackSnorm3x10_1x2(v.normal)),
+            glm::unpackHalf2x16(v.textureCoordinates)};
+}
+
+// Quantizes against the bounds of the vertices, as Mesh does
+void checkCompressVertices(const std::vector<lgl::Vertex> &vertices) {
+    lgl::Aabb bounds;
+    for (const auto &v : vertices) {
+        bounds = lgl::merge(bounds, v.position);
+    }
+    const auto positionOffset = bounds.min;
+    const auto positionScale = bounds.max - bounds.min;
+
+    const auto compactVertices = lgl::compressVertices(vertices, positionScale, positionOffset);
+    CHECK(compactVertices.size() == vertices.size());
+    for (std::size_t i = 0; i < compactVertices.size(); ++i) {
+        const auto &expected = vertices[i];
+        const auto actual = decompress(compactVertices[i], positionScale, positionOffset);
+        CHECK(compactVertices[i].padding == 0u);
+
+        // Rounding to the nearest of 65536 steps over the extent, which is
+        // exact along an axis without extent
+        for (auto axis = 0; axis < 3; ++axis) {
+            CHECK(std::abs(actual.position[axis] - expected.position[axis]) <= positionScale[axis] / 65535.0f);
+        }
+
+        // Rounding to the nearest of 511 steps either side of zero
+        for (auto axis = 0; axis < 3; ++axis) {
+            CHECK(std::abs(actual.normal[axis] - expected.normal[axis]) <= 1.0f / 511.0f);
+        }
+
+        // 11 significant bits, down to the smallest normal half float
+        for (auto axis = 0; axis < 2; ++axis) {
+            const auto magnitude = std::max(std::abs(expected.textureCoordinates[axis]), std::ldexp(1.0f, -14));
+            CHECK(std::abs(actual.textureCoordinates[axis] - expected.textureCoordinates[axis]) <=
+                  magnitude * std::ldexp(1.0f, -11));
+        }
+    }
+}
+
+glm::vec3 getRandomNormal(std::mt19937 &random) {
+    std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+    glm::vec3 normal;
+    do {
+        normal = {component(random), component(random), component(random)};
+    } while (glm::length(normal) < 0.01f);
+    return glm::normalize(normal);
+}
+
+void testRandomVertices() {
+    std::mt19937 random(31);
+    std::uniform_real_distribution<float> position(-40.0f, 25.0f);
+    std::uniform_real_distribution<float> textureCoordinate(-4.0f, 4.0f);
+
+    std::vector<lgl::Vertex> vertices;
+    for (auto i = 0; i < 10000; ++i) {
+        vertices.emplace_back(glm::vec3(position(random), 0.01f * position(random), 100.0f * position(random)),
+                              getRandomNormal(random),
+                              glm::vec2(textureCoordinate(random), textureCoordinate(random)));
+    }
+
+    // Normals along the axes and texture coordinates at the ends of the range
+    vertices.emplace_back(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec2(0.0f, 1.0f));
+    vertices.emplace_back(glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec2(1.0f, 0.0f));
+    vertices.emplace_back(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(-1.0f, 1e-5f));
+    checkCompressVertices(vertices);
+}
+
+// A flat mesh has no extent along its normal, where everything decodes to the offset
+void testFlatVertices() {
+    std::mt19937 random(32);
+    std::uniform_real_distribution<float> position(-3.0f, 7.0f);
+    std::uniform_real_distribution<float> textureCoordinate(0.0f, 1.0f);
+
+    std::vector<lgl::Vertex> vertices;
+    for (auto i = 0; i < 1000; ++i) {
+        vertices.emplace_back(glm::vec3(position(random), 2.5f, position(random)),
+                              glm::vec3(0.0f, 1.0f, 0.0f),
+                              glm::vec2(textureCoordinate(random), textureCoordinate(random)));
+    }
+    checkCompressVertices(vertices);
+
+    const auto compactVertices = lgl::compressVertices(vertices, {10.0f, 0.0f, 10.0f}, {-3.0f, 2.5f, -3.0f});
+    CHECK(std::all_of(compactVertices.cbegin(), compactVertices.cend(),
+                      [](const lgl::CompactVertex &v){ return v.position[1] == 0u; }));
+}
+
+} // namespace
+
+int main() {
+    testRandomVertices();
+    testFlatVertices();
+    return check::getNumFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}